@@ -0,0 +1,152 @@
+#include "Engine/Core/ThreadPool.hpp"
+
+ThreadPool* ThreadPool::instance = nullptr;
+
+//Set on pool workers and on any thread currently inside ParallelFor, so nested calls run inline instead of deadlocking.
+static thread_local bool t_isInsideParallelFor = false;
+
+//-----------------------------------------------------------------------------------
+ThreadPool::ThreadPool(unsigned int numWorkerThreads)
+	: m_isBusy(false)
+	, m_isJobActive(false)
+	, m_isShuttingDown(false)
+	, m_jobGeneration(0)
+	, m_numWorkersInJob(0)
+	, m_currentJob(nullptr)
+	, m_jobCount(0)
+	, m_jobGrainSize(1)
+	, m_nextChunkStart(0)
+	, m_numChunksRemaining(0)
+{
+	m_workers.reserve(numWorkerThreads);
+	for (unsigned int workerIndex = 0; workerIndex < numWorkerThreads; ++workerIndex)
+	{
+		m_workers.push_back(std::thread(&ThreadPool::WorkerMain, this));
+	}
+}
+
+//-----------------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isShuttingDown = true;
+	}
+	m_wakeCondition.notify_all();
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int ThreadPool::GetDefaultNumWorkerThreads()
+{
+	unsigned int numHardwareThreads = std::thread::hardware_concurrency();
+	return (numHardwareThreads > 1) ? numHardwareThreads - 1 : 0; //Leave a core for the main thread, which joins in anyway.
+}
+
+//-----------------------------------------------------------------------------------
+void ThreadPool::ParallelFor(unsigned int count, unsigned int grainSize, const RangeJob& job)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	grainSize = (grainSize > 0) ? grainSize : 1;
+
+	bool wasIdle = false;
+	if (m_workers.empty() || count <= grainSize || t_isInsideParallelFor || !m_isBusy.compare_exchange_strong(wasIdle, true))
+	{
+		job(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_currentJob = &job;
+		m_jobCount = count;
+		m_jobGrainSize = grainSize;
+		m_nextChunkStart.store(0);
+		m_numChunksRemaining.store((count + grainSize - 1) / grainSize);
+		m_isJobActive = true;
+		++m_jobGeneration;
+	}
+	m_wakeCondition.notify_all();
+
+	t_isInsideParallelFor = true;
+	RunChunks();
+	t_isInsideParallelFor = false;
+
+	//Other threads may still be finishing the chunks they grabbed.
+	while (m_numChunksRemaining.load() > 0)
+	{
+		std::this_thread::yield();
+	}
+
+	{
+		//No worker may touch the job once we return, since it lives on our caller's stack.
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workersIdleCondition.wait(lock, [this] { return m_numWorkersInJob == 0; });
+		m_isJobActive = false;
+		m_currentJob = nullptr;
+	}
+	m_isBusy.store(false);
+}
+
+//-----------------------------------------------------------------------------------
+void ThreadPool::ParallelFor(ThreadPool* threadPool, unsigned int count, unsigned int grainSize, const RangeJob& job)
+{
+	if (threadPool != nullptr)
+	{
+		threadPool->ParallelFor(count, grainSize, job);
+	}
+	else if (count > 0)
+	{
+		job(0, count);
+	}
+}
+
+//-----------------------------------------------------------------------------------
+void ThreadPool::WorkerMain()
+{
+	t_isInsideParallelFor = true;
+	unsigned int lastSeenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [this, lastSeenGeneration] { return m_isShuttingDown || (m_isJobActive && m_jobGeneration != lastSeenGeneration); });
+			if (m_isShuttingDown)
+			{
+				return;
+			}
+			lastSeenGeneration = m_jobGeneration;
+			++m_numWorkersInJob;
+		}
+
+		RunChunks();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_numWorkersInJob;
+		}
+		m_workersIdleCondition.notify_one();
+	}
+}
+
+//-----------------------------------------------------------------------------------
+void ThreadPool::RunChunks()
+{
+	while (true)
+	{
+		unsigned int chunkStart = m_nextChunkStart.fetch_add(m_jobGrainSize);
+		if (chunkStart >= m_jobCount)
+		{
+			return;
+		}
+		unsigned int chunkEnd = (chunkStart + m_jobGrainSize < m_jobCount) ? chunkStart + m_jobGrainSize : m_jobCount;
+		(*m_currentJob)(chunkStart, chunkEnd);
+		m_numChunksRemaining.fetch_sub(1);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//-----------------------------------------------------------------------------------
+//Fixed set of worker threads that cooperatively run data-parallel ranges.
+//The calling thread always helps, so a pool with 0 workers simply runs everything inline.
+class ThreadPool
+{
+public:
+	typedef std::function<void(unsigned int begin, unsigned int end)> RangeJob;
+
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ThreadPool(unsigned int numWorkerThreads = GetDefaultNumWorkerThreads());
+	~ThreadPool();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	//Splits [0, count) into chunks of grainSize and blocks until every chunk has run.
+	//Runs inline when the range fits in one chunk, or when called from inside another ParallelFor.
+	void ParallelFor(unsigned int count, unsigned int grainSize, const RangeJob& job);
+	//Same, on threadPool if there is one, else as a single inline job( 0, count ).
+	static void ParallelFor(ThreadPool* threadPool, unsigned int count, unsigned int grainSize, const RangeJob& job);
+	inline unsigned int GetNumThreads() const { return m_workers.size() + 1; };
+	static unsigned int GetDefaultNumWorkerThreads();
+
+	//STATIC VARIABLES//////////////////////////////////////////////////////////////////////////
+	static ThreadPool* instance;
+
+private:
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void WorkerMain();
+	void RunChunks();
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCondition;
+	std::condition_variable m_workersIdleCondition;
+	std::atomic<bool> m_isBusy;
+	bool m_isJobActive;
+	bool m_isShuttingDown;
+	unsigned int m_jobGeneration;
+	unsigned int m_numWorkersInJob;
+	const RangeJob* m_currentJob;
+	unsigned int m_jobCount;
+	unsigned int m_jobGrainSize;
+	std::atomic<unsigned int> m_nextChunkStart;
+	std::atomic<unsigned int> m_numChunksRemaining;
+};
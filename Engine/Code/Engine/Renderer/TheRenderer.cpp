@@ -337,6 +337,24 @@ void TheRenderer::BindAndBufferVBOData(int vboID, const Vertex_PCT* vertexes, in
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+//-----------------------------------------------------------------------------------
+void TheRenderer::BindAndBufferStreamingVBOData(int vboID, const Vertex_PCT* vertexes, int numVerts)
+{
+	CHECK_RENDERER;
+	glBindBuffer(GL_ARRAY_BUFFER, vboID);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex_PCT) * numVerts, vertexes, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+//-----------------------------------------------------------------------------------
+void TheRenderer::BindAndBufferIBOData(int iboID, const unsigned int* indexes, int numIndexes)
+{
+	CHECK_RENDERER;
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numIndexes, indexes, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
 //-----------------------------------------------------------------------------------
 void TheRenderer::DrawVertexArray(const Vertex_PCT* vertexes, int numVertexes, DrawMode drawMode /*= QUADS*/, Texture* texture /*= nullptr*/)
 {
@@ -389,6 +407,36 @@ void TheRenderer::DrawVBO_PCT(unsigned int vboID, int numVerts, DrawMode drawMod
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+//-----------------------------------------------------------------------------------
+void TheRenderer::DrawIndexedVBO_PCT(unsigned int vboID, unsigned int iboID, int numIndexes, DrawMode drawMode /*= TRIANGLES*/, Texture* texture /*= nullptr*/)
+{
+	CHECK_RENDERER;
+	if (!texture)
+	{
+		texture = m_defaultTexture;
+	}
+	BindTexture(*texture);
+	glBindBuffer(GL_ARRAY_BUFFER, vboID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	glVertexPointer(3, GL_FLOAT, sizeof(Vertex_PCT), (const GLvoid*)offsetof(Vertex_PCT, pos));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex_PCT), (const GLvoid*)offsetof(Vertex_PCT, color));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex_PCT), (const GLvoid*)offsetof(Vertex_PCT, texCoords));
+
+	glDrawElements(GetDrawMode(drawMode), numIndexes, GL_UNSIGNED_INT, (const GLvoid*)0);
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 //-----------------------------------------------------------------------------------
 void TheRenderer::DrawText2D
 	( const Vector2& startBottomLeft
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <cstring>
 #include "Engine/Renderer/RGBA.hpp"
 #include "Engine/Math/Vector2.hpp"
 #include "Engine/Math/Vector3.hpp"
@@ -70,8 +71,11 @@ public:
 	int GenerateBufferID();
 	void DeleteBuffers(int vboID);
 	void BindAndBufferVBOData(int vboID, const Vertex_PCT* vertexes, int numVerts);
+	void BindAndBufferStreamingVBOData(int vboID, const Vertex_PCT* vertexes, int numVerts); //For vertexes rewritten every frame.
+	void BindAndBufferIBOData(int iboID, const unsigned int* indexes, int numIndexes);
 	void DrawVertexArray(const Vertex_PCT* vertexes, int numVertexes, DrawMode drawMode = QUADS, Texture* texture = nullptr); 
 	void DrawVBO_PCT(unsigned int vboID, int numVerts, DrawMode drawMode = QUADS, Texture* texture = nullptr);
+	void DrawIndexedVBO_PCT(unsigned int vboID, unsigned int iboID, int numIndexes, DrawMode drawMode = TRIANGLES, Texture* texture = nullptr);
 
 	//DRAWING//////////////////////////////////////////////////////////////////////////
 	void DrawPoint(const Vector2& point, const RGBA& color = RGBA::WHITE, float pointSize = 1.0f);
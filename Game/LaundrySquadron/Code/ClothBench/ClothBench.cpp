@@ -0,0 +1,296 @@
+//Headless cloth benchmark: builds a Cloth for every combination of the swept solvers, rows, cols, solver iterations and thread counts,
+//steps it for a fixed amount of simulated time, and prints one JSON document of per-run timings to stdout (or --out).
+//Solvers step at different rates (implicit takes one 1/60 s step where the others take four), so compare them by ms_per_simulated_second.
+//
+//	ClothBench [--rows 32,128] [--cols 32,128] [--iterations 1,5] [--threads 1,4] [--seconds 2]
+//			   [--solver pbd,xpbd,jacobi,implicit] [--tolerance 0] [--sleep on|off] [--tethers on|off] [--hierarchy auto|on|off]
+//			   [--out results.json]
+#include "Game/Cloth.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include "Engine/Time/Time.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const float FRAME_SECONDS = 1.f / 60.f; //Four of the cloth's fixed steps, well under its per-Update cap.
+static const float PARTICLE_MASS = 1.f;
+static const float PARTICLE_RADIUS = .01f;
+static const double BASE_DISTANCE = 1.0;
+static const char* SOLVER_NAMES[ NUM_CLOTH_SOLVER_TYPES ] = { "pbd", "xpbd", "jacobi", "implicit" };
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct BenchSettings
+{
+	std::vector<int> m_rows;
+	std::vector<int> m_cols;
+	std::vector<int> m_iterations;
+	std::vector<int> m_threads;
+	float m_seconds;
+	std::vector<ClothSolverType> m_solverTypes;
+	float m_tolerance; //0 by default, so every run does all its passes and timings stay comparable between builds.
+	bool m_useSleep; //Off by default: a settled cloth costs nothing, which isn't what a regression gate wants to time.
+	bool m_useTethers; //On by default, like the cloth.
+	int m_hierarchy; //-1 leaves the cloth's own size-based default.
+	std::string m_outputPath;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct BenchResult
+{
+	ClothSolverType m_solverType;
+	int m_rows;
+	int m_cols;
+	int m_iterations;
+	int m_threads;
+	unsigned int m_numParticles;
+	unsigned int m_numConstraints;
+	unsigned int m_numFixedSteps;
+	unsigned long long m_numConstraintProjections; //Constraints times solver passes actually run.
+	double m_totalSeconds;
+	double m_solveSeconds;
+	double m_nsPerParticleStep;
+	double m_nsPerConstraint;
+	double m_msPerSimulatedSecond;
+	double m_finalResidual;
+	double m_finalRmsStrain;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static std::vector<int> ParseIntList( const char* commaSeparated )
+{
+	std::vector<int> values;
+	const char* cursor = commaSeparated;
+	while ( *cursor != '\0' )
+	{
+		char* end = nullptr;
+		long value = strtol( cursor, &end, 10 );
+		if ( end == cursor )
+			break;
+
+		values.push_back( static_cast<int>( value ) );
+		cursor = ( *end == ',' ) ? end + 1 : end;
+	}
+	return values;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool ParseSolverList( const char* commaSeparated, std::vector<ClothSolverType>& out_solverTypes )
+{
+	out_solverTypes.clear();
+	std::string names = commaSeparated;
+	size_t nameStart = 0;
+	while ( nameStart <= names.size() )
+	{
+		size_t nameEnd = names.find( ',', nameStart );
+		if ( nameEnd == std::string::npos )
+			nameEnd = names.size();
+
+		std::string name = names.substr( nameStart, nameEnd - nameStart );
+		int solverIndex = 0;
+		while ( solverIndex < NUM_CLOTH_SOLVER_TYPES && name != SOLVER_NAMES[ solverIndex ] )
+			++solverIndex;
+		if ( solverIndex == NUM_CLOTH_SOLVER_TYPES )
+			return false;
+
+		out_solverTypes.push_back( static_cast<ClothSolverType>( solverIndex ) );
+		nameStart = nameEnd + 1;
+	}
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void PrintUsage()
+{
+	fprintf( stderr, "ClothBench [--rows 32,128] [--cols 32,128] [--iterations 1,5] [--threads 1,4] [--seconds 2]\n" );
+	fprintf( stderr, "           [--solver pbd,xpbd,jacobi,implicit] [--tolerance 0] [--sleep on|off] [--tethers on|off]\n" );
+	fprintf( stderr, "           [--hierarchy auto|on|off] [--out results.json]\n" );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool ParseSettings( int argc, char** argv, BenchSettings& out_settings )
+{
+	unsigned int numHardwareThreads = ThreadPool::GetDefaultNumWorkerThreads() + 1;
+	out_settings.m_rows = { 32, 128 };
+	out_settings.m_cols = { 32, 128 };
+	out_settings.m_iterations = { 1, 5 };
+	out_settings.m_threads = { 1 };
+	if ( numHardwareThreads > 1 )
+		out_settings.m_threads.push_back( static_cast<int>( numHardwareThreads ) );
+	out_settings.m_seconds = 2.f;
+	out_settings.m_solverTypes = { CLOTH_SOLVER_PBD };
+	out_settings.m_tolerance = 0.f;
+	out_settings.m_useSleep = false;
+	out_settings.m_useTethers = true;
+	out_settings.m_hierarchy = -1;
+
+	for ( int argIndex = 1; argIndex < argc; argIndex += 2 )
+	{
+		std::string name = argv[ argIndex ];
+		if ( ( argIndex + 1 ) >= argc )
+			return false;
+
+		const char* value = argv[ argIndex + 1 ];
+		if ( name == "--rows" )
+			out_settings.m_rows = ParseIntList( value );
+		else if ( name == "--cols" )
+			out_settings.m_cols = ParseIntList( value );
+		else if ( name == "--iterations" )
+			out_settings.m_iterations = ParseIntList( value );
+		else if ( name == "--threads" )
+			out_settings.m_threads = ParseIntList( value );
+		else if ( name == "--seconds" )
+			out_settings.m_seconds = static_cast<float>( atof( value ) );
+		else if ( name == "--tolerance" )
+			out_settings.m_tolerance = static_cast<float>( atof( value ) );
+		else if ( name == "--sleep" )
+			out_settings.m_useSleep = ( std::string( value ) == "on" );
+		else if ( name == "--tethers" )
+			out_settings.m_useTethers = ( std::string( value ) != "off" );
+		else if ( name == "--hierarchy" )
+			out_settings.m_hierarchy = ( std::string( value ) == "on" ) ? 1 : ( ( std::string( value ) == "off" ) ? 0 : -1 );
+		else if ( name == "--out" )
+			out_settings.m_outputPath = value;
+		else if ( name == "--solver" )
+		{
+			if ( !ParseSolverList( value, out_settings.m_solverTypes ) )
+				return false;
+		}
+		else
+			return false;
+	}
+
+	bool hasEveryAxis = !out_settings.m_solverTypes.empty() && !out_settings.m_rows.empty() && !out_settings.m_cols.empty() && !out_settings.m_iterations.empty() && !out_settings.m_threads.empty();
+	return hasEveryAxis && out_settings.m_seconds > 0.f;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static BenchResult RunOne( const BenchSettings& settings, ClothSolverType solverType, int numRows, int numCols, int numIterations, int numThreads )
+{
+	//numThreads counts the calling thread, which always helps; 1 runs the cloth with no pool at all.
+	ThreadPool* threadPool = ( numThreads > 1 ) ? new ThreadPool( numThreads - 1 ) : nullptr;
+	Cloth* cloth = new Cloth( Vector3::ZERO, PARTICLE_AABB3, PARTICLE_MASS, PARTICLE_RADIUS, numRows, numCols, numIterations,
+							  BASE_DISTANCE, sqrt( 2.0 ), 2.0 );
+	cloth->SetThreadPool( threadPool );
+	cloth->SetSolverType( solverType );
+	cloth->SetNumSubsteps( numIterations ); //XPBD's counterpart of iterations: one pass per substep. Implicit keeps its own CG cap.
+	cloth->SetSolverTolerance( settings.m_tolerance );
+	cloth->SetUseSleep( settings.m_useSleep );
+	cloth->SetUseTethers( settings.m_useTethers );
+	if ( settings.m_hierarchy >= 0 )
+		cloth->SetUseHierarchicalSolver( settings.m_hierarchy == 1 );
+
+	BenchResult result;
+	result.m_solverType = solverType;
+	result.m_rows = numRows;
+	result.m_cols = numCols;
+	result.m_iterations = numIterations;
+	result.m_threads = numThreads;
+	result.m_numParticles = cloth->GetNumParticles();
+	result.m_numConstraints = cloth->GetNumConstraints();
+	result.m_numFixedSteps = 0;
+	result.m_numConstraintProjections = 0;
+	result.m_solveSeconds = 0.0;
+
+	//Whole frames only, so every run covers exactly the same simulated time.
+	int numFrames = static_cast<int>( ceilf( settings.m_seconds / FRAME_SECONDS ) );
+	double startSeconds = GetCurrentTimeSeconds();
+	for ( int frameIndex = 0; frameIndex < numFrames; ++frameIndex )
+	{
+		cloth->Update( FRAME_SECONDS );
+		const ClothSolveRecord& solveRecord = cloth->GetSolveRecord( 0 );
+		result.m_numFixedSteps += solveRecord.m_numFixedSteps;
+		result.m_numConstraintProjections += static_cast<unsigned long long>( solveRecord.m_numIterations ) * cloth->GetNumConstraints();
+		result.m_solveSeconds += solveRecord.m_milliseconds / 1000.0;
+	}
+	result.m_totalSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	double numParticleSteps = static_cast<double>( result.m_numParticles ) * result.m_numFixedSteps;
+	result.m_nsPerParticleStep = ( numParticleSteps > 0.0 ) ? ( result.m_totalSeconds * 1e9 ) / numParticleSteps : 0.0;
+	result.m_nsPerConstraint = ( result.m_numConstraintProjections > 0 ) ? ( result.m_solveSeconds * 1e9 ) / static_cast<double>( result.m_numConstraintProjections ) : 0.0;
+	result.m_msPerSimulatedSecond = ( result.m_totalSeconds * 1000.0 ) / ( numFrames * FRAME_SECONDS );
+	result.m_finalResidual = cloth->GetLastSolveResidual();
+	result.m_finalRmsStrain = ( result.m_numConstraints > 0 ) ? sqrt( result.m_finalResidual / result.m_numConstraints ) / BASE_DISTANCE : 0.0;
+
+	delete cloth;
+	delete threadPool;
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void WriteJson( FILE* file, const BenchSettings& settings, const std::vector<BenchResult>& results )
+{
+	fprintf( file, "{\n" );
+	fprintf( file, "  \"simd\": \"%s\",\n", GetClothSimdLevelName( GetBestSupportedClothSimdLevel() ) );
+	fprintf( file, "  \"simulated_seconds\": %g,\n", settings.m_seconds );
+	fprintf( file, "  \"tolerance\": %g,\n", settings.m_tolerance );
+	fprintf( file, "  \"sleep\": %s,\n", settings.m_useSleep ? "true" : "false" );
+	fprintf( file, "  \"tethers\": %s,\n", settings.m_useTethers ? "true" : "false" );
+	fprintf( file, "  \"runs\": [\n" );
+	for ( unsigned int resultIndex = 0; resultIndex < results.size(); ++resultIndex )
+	{
+		const BenchResult& result = results[ resultIndex ];
+		fprintf( file, "    { \"solver\": \"%s\", \"rows\": %d, \"cols\": %d, \"iterations\": %d, \"threads\": %d, \"particles\": %u, \"constraints\": %u, "
+				 "\"fixed_steps\": %u, \"total_ms\": %.3f, \"solve_ms\": %.3f, \"ns_per_particle_step\": %.3f, \"ns_per_constraint\": %.3f, "
+				 "\"ms_per_simulated_second\": %.3f, \"final_residual\": %.9g, \"final_rms_strain\": %.9g }%s\n",
+				 SOLVER_NAMES[ result.m_solverType ], result.m_rows, result.m_cols, result.m_iterations, result.m_threads, result.m_numParticles, result.m_numConstraints,
+				 result.m_numFixedSteps, result.m_totalSeconds * 1000.0, result.m_solveSeconds * 1000.0, result.m_nsPerParticleStep, result.m_nsPerConstraint,
+				 result.m_msPerSimulatedSecond, result.m_finalResidual, result.m_finalRmsStrain, ( ( resultIndex + 1 ) < results.size() ) ? "," : "" );
+	}
+	fprintf( file, "  ]\n" );
+	fprintf( file, "}\n" );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	BenchSettings settings;
+	if ( !ParseSettings( argc, argv, settings ) )
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	std::vector<BenchResult> results;
+	for ( ClothSolverType solverType : settings.m_solverTypes )
+	{
+		for ( int numRows : settings.m_rows )
+		{
+			for ( int numCols : settings.m_cols )
+			{
+				for ( int numIterations : settings.m_iterations )
+				{
+					for ( int numThreads : settings.m_threads )
+					{
+						results.push_back( RunOne( settings, solverType, numRows, numCols, numIterations, numThreads ) );
+						fprintf( stderr, "%s %dx%d, %d iterations, %d threads: %.1f ns/particle/step, %.1f ms/simulated s\n", SOLVER_NAMES[ solverType ], numRows, numCols, numIterations,
+								 numThreads, results.back().m_nsPerParticleStep, results.back().m_msPerSimulatedSecond );
+					}
+				}
+			}
+		}
+	}
+
+	FILE* file = settings.m_outputPath.empty() ? stdout : fopen( settings.m_outputPath.c_str(), "w" );
+	if ( file == nullptr )
+	{
+		fprintf( stderr, "Can't write %s\n", settings.m_outputPath.c_str() );
+		return 1;
+	}
+	WriteJson( file, settings, results );
+	if ( file != stdout )
+		fclose( file );
+	return 0;
+}
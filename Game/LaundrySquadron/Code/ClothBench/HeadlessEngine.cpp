@@ -0,0 +1,60 @@
+//Stand-ins for the Windows/OpenGL parts of the engine the cloth code links against, so ClothBench builds and runs headless.
+//Cloth only renders when asked to, and the benchmark never asks, so drawing and loading are no-ops.
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Renderer/TheRenderer.hpp"
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/Vertex.hpp"
+#include "Engine/Renderer/AABB3.hpp"
+#include "Engine/Audio/Audio.hpp"
+#include "Engine/Time/Time.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+//--------------------------------------------------------------------------------------------------------------
+TheRenderer* TheRenderer::instance = nullptr;
+AudioSystem* AudioSystem::instance = nullptr;
+
+
+//--------------------------------------------------------------------------------------------------------------
+double GetCurrentTimeSeconds()
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DebuggerPrintf( const char* messageFormat, ... )
+{
+	UNUSED( messageFormat );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void FatalError( const char* filePath, const char* functionName, int lineNum, const std::string& reasonForError, const char* conditionText )
+{
+	fprintf( stderr, "FATAL %s(%d) %s: %s %s\n", filePath, lineNum, functionName, reasonForError.c_str(), ( conditionText != nullptr ) ? conditionText : "" );
+	exit( 1 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RecoverableWarning( const char* filePath, const char* functionName, int lineNum, const std::string& reasonForWarning, const char* conditionText )
+{
+	fprintf( stderr, "WARNING %s(%d) %s: %s %s\n", filePath, lineNum, functionName, reasonForWarning.c_str(), ( conditionText != nullptr ) ? conditionText : "" );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AudioSystem::PlaySound( SoundID soundID, float volumeLevel ) { UNUSED( soundID ); UNUSED( volumeLevel ); }
+Texture* Texture::CreateOrGetTexture( const std::string& imageFilePath ) { UNUSED( imageFilePath ); return nullptr; }
+void TheRenderer::DrawAABBBoundingBox( const AABB3& bounds, const RGBA& color ) { UNUSED( bounds ); UNUSED( color ); }
+void TheRenderer::DrawLine( const Vector3& start, const Vector3& end, const RGBA& color, float lineThickness ) { UNUSED( start ); UNUSED( end ); UNUSED( color ); UNUSED( lineThickness ); }
+void TheRenderer::DrawUVSphere( Vector3 position, float radius, float numSides ) { UNUSED( position ); UNUSED( radius ); UNUSED( numSides ); }
+void TheRenderer::DrawVertexArray( const Vertex_PCT* vertexes, int numVertexes, DrawMode drawMode, Texture* texture ) { UNUSED( vertexes ); UNUSED( numVertexes ); UNUSED( drawMode ); UNUSED( texture ); }
+int TheRenderer::GenerateBufferID() { return 1; }
+void TheRenderer::DeleteBuffers( int bufferID ) { UNUSED( bufferID ); }
+void TheRenderer::BindAndBufferStreamingVBOData( int vboID, const Vertex_PCT* vertexes, int numVertexes ) { UNUSED( vboID ); UNUSED( vertexes ); UNUSED( numVertexes ); }
+void TheRenderer::BindAndBufferIBOData( int iboID, const unsigned int* indexes, int numIndexes ) { UNUSED( iboID ); UNUSED( indexes ); UNUSED( numIndexes ); }
+void TheRenderer::DrawIndexedVBO_PCT( unsigned int vboID, unsigned int iboID, int numIndexes, DrawMode drawMode, Texture* texture ) { UNUSED( vboID ); UNUSED( iboID ); UNUSED( numIndexes ); UNUSED( drawMode ); UNUSED( texture ); }
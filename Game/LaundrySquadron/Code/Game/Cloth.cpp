@@ -0,0 +1,1035 @@
+#include "Game/Cloth.hpp"
+#include "Engine/Renderer/TheRenderer.hpp"
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/RGBA.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include "Engine/Time/Time.hpp"
+#include <cmath>
+#include <cstring>
+#include "Game/ClothConstraintKernels.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+const float Cloth::FIXED_TIME_STEP_SECONDS = 1.f / 240.f;
+const float Cloth::IMPLICIT_TIME_STEP_SECONDS = 1.f / 60.f;
+const float Cloth::DEFAULT_SELF_COLLISION_THICKNESS_RATIO = .45f;
+const float Cloth::DEFAULT_CHEBYSHEV_SPECTRAL_RADIUS = .9f;
+const float Cloth::JACOBI_RELAXATION = 1.5f;
+const float Cloth::DEFAULT_SLEEP_DISTANCE_RATIO = .0005f; //At 240 steps a second, an eighth of the base distance per second.
+const float Cloth::DEFAULT_SOLVER_TOLERANCE = .001f; //With the hierarchy, a hanging 64x64 sheet settles near 0.03% and takes one pass a step.
+static const float PBD_STIFFNESS_PER_SECOND = 100.f; //Shared by the Gauss-Seidel and Jacobi PBD solvers, so both converge toward the same drape.
+
+
+//--------------------------------------------------------------------------------------------------------------
+Cloth::Cloth( const Vector3& originTopLeftPosition,
+			  ParticleType particleRenderType, float particleMass, float particleRadius,
+			  int numRows, int numCols,
+			  unsigned int numConstraintSolverIterations,
+			  double baseDistanceBetweenParticles,
+			  double ratioDistanceStructuralToShear,
+			  double ratioDistanceStructuralToBend,
+			  const Vector3& initialGlobalVelocity /*= Vector3::ZERO*/ )
+	: m_particleTemplate( particleRenderType, particleMass, -1.f, particleRadius )
+	, m_originalTopLeftPosition( originTopLeftPosition )
+	, m_currentTopLeftPosition( originTopLeftPosition )
+	, m_numRows( numRows )
+	, m_numCols( numCols )
+	, m_particleMass( particleMass )
+	, m_numConstraintSolverIterations( numConstraintSolverIterations )
+	, m_baseDistanceBetweenParticles( baseDistanceBetweenParticles )
+	, m_ratioDistanceStructuralToShear( ratioDistanceStructuralToShear )
+	, m_ratioDistanceStructuralToBend( ratioDistanceStructuralToBend )
+	, m_threadPool( ThreadPool::instance )
+	, m_simdLevel( GetBestSupportedClothSimdLevel() )
+	, m_constraintKernel( GetConstraintProjectionKernel( m_simdLevel ) )
+	, m_xpbdKernel( GetXpbdProjectionKernel( m_simdLevel ) )
+	, m_solverType( CLOTH_SOLVER_PBD )
+	, m_numSubsteps( DEFAULT_NUM_SUBSTEPS )
+	, m_chebyshevSpectralRadius( DEFAULT_CHEBYSHEV_SPECTRAL_RADIUS )
+	, m_solverTolerance( DEFAULT_SOLVER_TOLERANCE )
+	, m_newestSolveRecord( 0 )
+	, m_numSolveRecords( 0 )
+	, m_numTornConstraints( 0 )
+	, m_numExpiredParticles( 0 )
+	, m_accumulatedSeconds( 0.f )
+	, m_interpolationAlpha( 1.f )
+	, m_numFixedStepsLastUpdate( 0 )
+	, m_useHierarchicalSolver( numRows >= MIN_SIDE_FOR_HIERARCHY && numCols >= MIN_SIDE_FOR_HIERARCHY )
+	, m_numHierarchyIterationsPerLevel( DEFAULT_HIERARCHY_ITERATIONS_PER_LEVEL )
+	, m_useTethers( true )
+	, m_useSelfCollision( false )
+	, m_useSleep( true )
+	, m_useAerodynamics( false )
+	, m_isBvhStale( true )
+	, m_clothTexture( nullptr )
+{
+	m_compliance[ STRETCH ] = 0.f; //Rigid, like the PBD mode. Raise SHEAR and BEND for softer drape.
+	m_compliance[ SHEAR ] = 0.f;
+	m_compliance[ BEND ] = 0.f;
+	m_tearStrain[ STRETCH ] = 0.f;
+	m_tearStrain[ SHEAR ] = 0.f;
+	m_tearStrain[ BEND ] = 0.f;
+	for ( ClothSolveRecord& record : m_solveHistory )
+		record = ClothSolveRecord();
+
+	m_particleTemplate.SetParticleState( new LinearDynamicsState() ); //Particle will handle state cleanup.
+	m_particles.Resize( numRows * numCols );
+
+	AssignParticleStates( static_cast<float>( baseDistanceBetweenParticles ), particleMass, initialGlobalVelocity );
+
+	AddConstraints( baseDistanceBetweenParticles, ratioDistanceStructuralToShear, ratioDistanceStructuralToBend );
+
+	m_hierarchy.BuildForGrid( numRows, numCols, static_cast<float>( baseDistanceBetweenParticles ) );
+	m_selfCollision.SetThickness( static_cast<float>( baseDistanceBetweenParticles ) * DEFAULT_SELF_COLLISION_THICKNESS_RATIO );
+	m_sleep.BuildForGrid( numRows, numCols );
+	m_sleep.SetSleepDistance( static_cast<float>( baseDistanceBetweenParticles ) * DEFAULT_SLEEP_DISTANCE_RATIO );
+	m_aerodynamics.BuildForGrid( numRows, numCols );
+	m_bvh.BuildForGrid( numRows, numCols );
+	m_mesh.BuildForGrid( numRows, numCols );
+
+	SetParticleIsPinned( GetParticleIndex( 0, 0 ), true );
+	SetParticleIsPinned( GetParticleIndex( 0, numCols - 1 ), true );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Cloth::~Cloth()
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool Cloth::IsDead() const
+{
+	return m_particles.IsExpired( GetParticleIndex( 0, 0 ) ) && m_particles.IsExpired( GetParticleIndex( 0, m_numCols - 1 ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+float Cloth::GetPercentageConstraintsLeft( ConstraintType constraintType /*= NUM_CONSTRAINT_TYPES*/ ) const
+{
+	return static_cast<float>( GetNumConstraints( constraintType ) ) / static_cast<float>( m_originalNumConstraints );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+int Cloth::GetNumConstraints( ConstraintType constraintType /*= NUM_CONSTRAINT_TYPES*/ ) const
+{
+	return static_cast<int>( m_clothConstraints.GetNumConstraints( constraintType ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::Update( float deltaSeconds )
+{
+	//Consume real time in fixed steps so stiffness and cost per wall-clock second don't depend on frame rate.
+	m_accumulatedSeconds += deltaSeconds;
+	const float fixedStepSeconds = GetFixedStepSeconds();
+	const float maxAccumulatedSeconds = MAX_FIXED_STEPS_PER_UPDATE * fixedStepSeconds;
+	if ( m_accumulatedSeconds > maxAccumulatedSeconds )
+		m_accumulatedSeconds = maxAccumulatedSeconds; //Frame spike: let the cloth fall behind rather than spiral into ever longer frames.
+
+	m_numFixedStepsLastUpdate = 0;
+	m_newestSolveRecord = ( m_newestSolveRecord + 1 ) % SOLVE_HISTORY_LENGTH;
+	if ( m_numSolveRecords < SOLVE_HISTORY_LENGTH )
+		++m_numSolveRecords;
+	ClothSolveRecord& solveRecord = m_solveHistory[ m_newestSolveRecord ];
+	solveRecord = ClothSolveRecord();
+	solveRecord.m_residual = GetSolveRecord( 1 ).m_residual; //Carried over when the Update is too short to take a step.
+	while ( m_accumulatedSeconds >= fixedStepSeconds )
+	{
+		if ( !m_sleep.IsEveryTileAsleep() ) //A cloth that has settled everywhere costs nothing per step until something wakes it.
+		{
+			m_particles.SaveStepStartPositions();
+			SimulateFixedStep( fixedStepSeconds );
+			m_isBvhStale = true;
+		}
+		m_accumulatedSeconds -= fixedStepSeconds;
+		++m_numFixedStepsLastUpdate;
+	}
+	solveRecord.m_numFixedSteps = m_numFixedStepsLastUpdate;
+
+	if ( m_useSleep && m_numFixedStepsLastUpdate > 0 )
+		m_sleep.Update( m_particles, m_clothConstraints, m_threadPool );
+
+	m_interpolationAlpha = m_accumulatedSeconds / fixedStepSeconds; //How far Render is between the last two fixed steps.
+
+	//Old way of pinning the corners. Now handled by the CLOTH_PARTICLE_PINNED flag to let you pin things arbitrarily.
+
+//	if ( IsParticleExpired( GetParticleIndex( 0, 0 ) ) == false )
+//		m_particles.SetPosition( GetParticleIndex( 0, 0 ), m_currentTopLeftPosition );
+//	if ( IsParticleExpired( GetParticleIndex( 0, m_numCols - 1 ) ) == false )
+//		m_particles.SetPosition( GetParticleIndex( 0, m_numCols - 1 ), CalcTopRightPosFromTopLeft() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SimulateFixedStep( float deltaSeconds )
+{
+	//XPBD splits the step instead of iterating on it: smaller steps converge faster than extra passes over one big step.
+	unsigned int numSubsteps = ( m_solverType == CLOTH_SOLVER_XPBD ) ? m_numSubsteps : 1;
+	float substepSeconds = deltaSeconds / static_cast<float>( numSubsteps );
+
+	for ( unsigned int substep = 0; substep < numSubsteps; ++substep )
+	{
+		bool isImplicit = ( m_solverType == CLOTH_SOLVER_IMPLICIT ); //Integrates and resolves the constraints in one solve.
+		if ( isImplicit )
+			StepImplicit( substepSeconds );
+		else
+			StepParticles( substepSeconds );
+		if ( m_useTethers ) //Before the passes, which then only have local error left to smooth out.
+			m_tethers.Solve( m_particles, m_clothConstraints, m_threadPool );
+		if ( !isImplicit )
+			SatisfyConstraints( substepSeconds );
+		if ( m_useSelfCollision ) //After the constraints, so separation has the last word on where particles end up this step.
+			m_selfCollision.Solve( m_particles, m_clothConstraints, m_threadPool );
+		UpdateParticleVelocities( substepSeconds );
+	}
+
+	TearOverstrainedConstraints();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::Render( bool showCloth /*= true*/, bool showConstraints /*= false*/, bool showParticles /*= false*/ )
+{
+	//Render the cloth "fabric" as one indexed draw; cells whose top-left particle was shot are already out of the index list.
+	if ( showCloth )
+	{
+		if ( m_clothTexture == nullptr )
+			m_clothTexture = Texture::CreateOrGetTexture( "Data/Images/Test.png" ); //Looked up once, not per quad.
+
+		m_mesh.Update( m_particles, m_interpolationAlpha, m_threadPool );
+		m_mesh.Render( m_clothTexture );
+	}
+
+	if ( showConstraints )
+	{
+		for ( const ClothConstraintBatch& batch : m_clothConstraints.m_batches )
+		{
+			for ( const ClothConstraint& cc : batch.m_constraints )
+			{
+				Vector3 particlePosition1 = GetRenderPosition( cc.p1 );
+				Vector3 particlePosition2 = GetRenderPosition( cc.p2 );
+
+				switch ( batch.m_type )
+				{
+				case STRETCH:	TheRenderer::instance->DrawLine( particlePosition1, particlePosition2, RGBA::RED ); break;
+				case SHEAR:		TheRenderer::instance->DrawLine( particlePosition1, particlePosition2, RGBA::GREEN ); break;
+				case BEND:		TheRenderer::instance->DrawLine( particlePosition1, particlePosition2, RGBA::BLUE ); break;
+				default:		break;
+				}
+			}
+		}
+	}
+
+	if ( !showParticles )
+		return;
+
+	for ( unsigned int particleIndex = 0; particleIndex < m_particles.GetNumParticles(); particleIndex++ )
+	{
+		if ( m_particles.IsExpired( particleIndex ) )
+			continue;
+
+		m_particleTemplate.SetPosition( GetRenderPosition( particleIndex ) );
+		m_particleTemplate.Render();
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::MoveClothByOffset( const Vector3& offset )
+{
+	m_sleep.WakeTilesOfRow( 0, m_particles );
+	for ( int c = 0; c < m_numCols; c++ )
+	{
+		unsigned int particleIndex = GetParticleIndex( 0, c );
+		m_particles.Translate( particleIndex, offset );
+		m_particles.SetPreviousPosition( particleIndex, m_particles.GetPreviousPosition( particleIndex ) + offset );
+		m_particles.SetStepStartPosition( particleIndex, m_particles.GetStepStartPosition( particleIndex ) + offset ); //Else Render smears the move across a frame.
+	}
+	m_currentTopLeftPosition = m_particles.GetPosition( GetParticleIndex( 0, 0 ) );
+	m_isBvhStale = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::ResetForces( bool keepGravity /*= true*/ )
+{
+	m_sleep.WakeAll( m_particles );
+	m_forceFields.Clear( keepGravity );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::AddForce( Force* force )
+{
+	m_sleep.WakeAll( m_particles );
+	m_forceFields.AddForce( force );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SetParticleIsExpired( unsigned int particleIndex, bool newVal )
+{
+	bool wasExpired = m_particles.IsExpired( particleIndex );
+	if ( newVal == wasExpired )
+		return; //Nothing to wake, rebuild or remove.
+
+	m_sleep.WakeTileOfParticle( particleIndex, m_particles ); //Else waking would restore the inverse mass from before this change.
+	m_particles.SetIsExpired( particleIndex, newVal );
+	UpdateInverseMass( particleIndex );
+	m_tethers.MarkDirty(); //An expired pin holds nothing anymore.
+	if ( newVal )
+		++m_numExpiredParticles;
+	else
+		--m_numExpiredParticles;
+
+	if ( newVal )
+	{
+		m_clothConstraints.RemoveConstraintsBetweenExpiredParticles( particleIndex, m_particles );
+		m_hierarchy.MarkParticleDamaged( particleIndex / m_numCols, particleIndex % m_numCols );
+		RemoveCell( particleIndex / m_numCols, particleIndex % m_numCols ); //Don't draw a quad for a particle that's been shot.
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::TearOverstrainedConstraints()
+{
+	//Find in parallel, tear serially: tearing swap-removes from the batches being scanned.
+	m_tornConstraintIDs.clear();
+	for ( const ClothConstraintBatch& batch : GetSolveBatches() ) //Asleep, both ends are frozen at a strain that didn't tear.
+	{
+		float maxStrain = m_tearStrain[ batch.m_type ];
+		unsigned int numConstraints = batch.m_constraints.size();
+		if ( maxStrain <= 0.f || numConstraints == 0 )
+			continue;
+
+		unsigned int numChunks = ( numConstraints + CONSTRAINTS_PER_TASK - 1 ) / CONSTRAINTS_PER_TASK;
+		if ( m_chunkTornConstraintIDs.size() < numChunks )
+			m_chunkTornConstraintIDs.resize( numChunks );
+		for ( unsigned int chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex )
+			m_chunkTornConstraintIDs[ chunkIndex ].clear();
+
+		ThreadPool::ParallelFor( m_threadPool, numConstraints, CONSTRAINTS_PER_TASK, [ this, &batch, maxStrain ]( unsigned int begin, unsigned int end )
+		{
+			std::vector<unsigned int>& tornConstraintIDs = m_chunkTornConstraintIDs[ begin / CONSTRAINTS_PER_TASK ];
+			for ( unsigned int slot = begin; slot < end; slot++ )
+			{
+				const ClothConstraint& cc = batch.m_constraints[ slot ];
+				float dx = m_particles.m_positionX[ cc.p2 ] - m_particles.m_positionX[ cc.p1 ];
+				float dy = m_particles.m_positionY[ cc.p2 ] - m_particles.m_positionY[ cc.p1 ];
+				float dz = m_particles.m_positionZ[ cc.p2 ] - m_particles.m_positionZ[ cc.p1 ];
+				float maxDistance = cc.restDistance * maxStrain;
+				if ( ( dx * dx ) + ( dy * dy ) + ( dz * dz ) > maxDistance * maxDistance )
+					tornConstraintIDs.push_back( batch.m_constraintIDs[ slot ] );
+			}
+		} );
+
+		for ( unsigned int chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex )
+			m_tornConstraintIDs.insert( m_tornConstraintIDs.end(), m_chunkTornConstraintIDs[ chunkIndex ].begin(), m_chunkTornConstraintIDs[ chunkIndex ].end() );
+	}
+
+	for ( unsigned int constraintID : m_tornConstraintIDs )
+		TearConstraint( constraintID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::TearConstraint( unsigned int constraintID )
+{
+	//Every update here is O(1) per tear, so a fast rip costs no more than the constraints it breaks.
+	ClothConstraint cc = m_clothConstraints.GetConstraint( constraintID );
+	ConstraintType constraintType = m_clothConstraints.GetConstraintType( constraintID );
+	m_clothConstraints.RemoveConstraint( constraintID );
+	++m_numTornConstraints;
+
+	int row1 = cc.p1 / m_numCols;
+	int col1 = cc.p1 % m_numCols;
+	int row2 = cc.p2 / m_numCols;
+	int col2 = cc.p2 % m_numCols;
+	m_hierarchy.MarkParticleDamaged( row1, col1 );
+	m_hierarchy.MarkParticleDamaged( row2, col2 );
+
+	//A torn structural edge opens the two cells either side of it; shear and bend tears alone leave the surface whole.
+	if ( constraintType != STRETCH )
+		return;
+	if ( row1 == row2 ) //Horizontal edge: the cells above and below.
+	{
+		int leftCol = ( col1 < col2 ) ? col1 : col2;
+		RemoveCell( row1 - 1, leftCol );
+		RemoveCell( row1, leftCol );
+	}
+	else //Vertical edge: the cells left and right.
+	{
+		int topRow = ( row1 < row2 ) ? row1 : row2;
+		RemoveCell( topRow, col1 - 1 );
+		RemoveCell( topRow, col1 );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::RemoveCell( int rowStartTop, int colStartLeft )
+{
+	m_mesh.RemoveCell( rowStartTop, colStartLeft );
+	m_aerodynamics.RemoveCell( rowStartTop, colStartLeft );
+	m_bvh.RemoveCell( rowStartTop, colStartLeft );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SetParticleIsPinned( unsigned int particleIndex, bool newVal )
+{
+	m_sleep.WakeTileOfParticle( particleIndex, m_particles );
+	m_particles.SetIsPinned( particleIndex, newVal );
+	UpdateInverseMass( particleIndex );
+	m_tethers.MarkDirty();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::PlaceParticle( unsigned int particleIndex, const Vector3& position, const Vector3& velocity )
+{
+	m_sleep.WakeTileOfParticle( particleIndex, m_particles );
+	m_particles.SetPosition( particleIndex, position );
+	m_particles.SetPreviousPosition( particleIndex, position - ( velocity * GetFixedStepSeconds() ) ); //Verlet reads the velocity back out of x - x_prev.
+	m_particles.SetStepStartPosition( particleIndex, position ); //Render shows it there right away instead of sliding in from the old spot.
+	m_particles.SetVelocity( particleIndex, velocity );
+	m_isBvhStale = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::UpdateInverseMass( unsigned int particleIndex )
+{
+	//Shooting a pinned particle frees it to fall with the rest of the cloth.
+	bool isHeldInPlace = m_particles.IsPinned( particleIndex ) && !m_particles.IsExpired( particleIndex );
+	m_particles.m_inverseMass[ particleIndex ] = isHeldInPlace ? 0.f : ( 1.f / m_particleMass ); //Integrator and constraint kernels never move a zero inverse mass.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SetSimdLevel( ClothSimdLevel level )
+{
+	m_constraintKernel = GetConstraintProjectionKernel( level );
+	m_xpbdKernel = GetXpbdProjectionKernel( level );
+	m_simdLevel = ( level > GetBestSupportedClothSimdLevel() ) ? GetBestSupportedClothSimdLevel() : level;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::RemoveAllConstraints()
+{
+	m_sleep.WakeAll( m_particles ); //Nothing holds the particles up anymore.
+	m_clothConstraints.Clear();
+	m_hierarchy.Clear(); //Its coarse constraints would otherwise keep holding the cloth together.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::AssignParticleStates( float baseDistance, float particleMass, const Vector3& velocity /*= Vector3::ZERO*/ )
+{
+	//FORCES ASSIGNED HERE RIGHT NOW:
+	AddForce( new GravityForce( 9.81f, Vector3( 0, 0, -1 ) ) );
+	//AddForce( new SpringForce( 0, Vector3::ZERO, .72f, .72f ) );
+	//AddForce( new ConstantWindForce( 30.f, Vector3::UP ) );
+	//AddForce( new WormholeForce( m_currentTopLeftPosition, 2.f, Vector3::ONE ) );
+
+	for ( int r = 0; r < m_numRows; r++ )
+	{
+		for ( int c = 0; c < m_numCols; c++ )
+		{
+			Vector3 startPosition( c * baseDistance, 0.0f, -r * baseDistance ); //BASIS CHANGE GOES HERE!
+			startPosition += m_currentTopLeftPosition;
+			unsigned int particleIndex = GetParticleIndex( r, c );
+
+			m_particles.SetPosition( particleIndex, startPosition );
+			m_particles.SetPreviousPosition( particleIndex, startPosition - ( velocity * FIXED_TIME_STEP_SECONDS ) ); //Verlet reads the initial velocity back out of x - x_prev.
+			m_particles.SetStepStartPosition( particleIndex, startPosition );
+			m_particles.SetVelocity( particleIndex, velocity );
+			m_particles.m_inverseMass[ particleIndex ] = 1.f / particleMass;
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector3 Cloth::CalcTopRightPosFromTopLeft()
+{
+	m_currentTopRightPosition = m_currentTopLeftPosition;
+	m_currentTopRightPosition.x += ( ( m_numCols - 1 ) * static_cast<float>( m_baseDistanceBetweenParticles ) ); //Might need to change direction per engine basis.
+	return m_currentTopRightPosition;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SetDistancesForConstraints( ConstraintType affectedType, double newRestDistance )
+{
+	m_clothConstraints.SetRestDistanceForType( affectedType, static_cast<float>( newRestDistance ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::AddConstraints( double baseDistance, double ratioStructuralToShear, double ratioStructuralToBend )
+{
+	double shearDist = baseDistance * ratioStructuralToShear;
+	double bendDist = baseDistance * ratioStructuralToBend;
+
+	m_clothConstraints.BuildForGrid( m_numRows, m_numCols, static_cast<float>( baseDistance ), static_cast<float>( shearDist ), static_cast<float>( bendDist ) );
+
+	m_originalNumConstraints = m_clothConstraints.GetNumConstraints();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::ParallelForAwakeParticles( const std::function<void( unsigned int, unsigned int )>& job )
+{
+	if ( !m_sleep.HasSleepingTiles() )
+	{
+		ThreadPool::ParallelFor( m_threadPool, m_particles.GetNumParticles(), PARTICLES_PER_TASK, job );
+		return;
+	}
+
+	const std::vector<ClothSleep::ParticleRange>& awakeRanges = m_sleep.GetAwakeRanges();
+	ThreadPool::ParallelFor( m_threadPool, awakeRanges.size(), AWAKE_RANGES_PER_TASK, [ &awakeRanges, &job ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int rangeIndex = begin; rangeIndex < end; rangeIndex++ )
+			job( awakeRanges[ rangeIndex ].begin, awakeRanges[ rangeIndex ].end );
+	} );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+std::vector<ClothConstraintBatch>& Cloth::GetSolveBatches()
+{
+	if ( m_sleep.HasSleepingTiles() )
+		return m_sleep.GetAwakeBatches( m_clothConstraints );
+	return m_clothConstraints.m_batches;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SetUseSleep( bool useSleep )
+{
+	m_useSleep = useSleep;
+	if ( !useSleep )
+		m_sleep.WakeAll( m_particles );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SetWindVelocity( const Vector3& windVelocity )
+{
+	m_aerodynamics.SetWindVelocity( windVelocity );
+	m_sleep.WakeAll( m_particles ); //A tile that settled in the old wind won't notice the new one by itself.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool Cloth::SweepSphere( const Vector3& start, const Vector3& end, float radius, ClothSweepHit& out_hit )
+{
+	if ( m_isBvhStale )
+	{
+		m_bvh.Refit( m_particles, m_threadPool );
+		m_isBvhStale = false;
+	}
+	return m_bvh.SweepSphere( start, end, radius, m_particles, out_hit );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::StepParticles( float deltaSeconds )
+{
+	//Triangle forces first, over every cell, since each awake particle gathers from cells whose other corners may be asleep.
+	if ( m_useAerodynamics )
+		m_aerodynamics.ComputeTriangleForces( m_particles, m_threadPool );
+
+	//Position Verlet: every particle carries its own previous position, so particles can be stepped in any order or in parallel.
+	ParallelForAwakeParticles( [ this, deltaSeconds ]( unsigned int begin, unsigned int end )
+	{
+		float* accelerationX = m_particles.m_accelerationX.data();
+		float* accelerationY = m_particles.m_accelerationY.data();
+		float* accelerationZ = m_particles.m_accelerationZ.data();
+		CalcParticleForces( begin, end );
+		for ( unsigned int particleIndex = begin; particleIndex < end; particleIndex++ )
+		{
+			float inverseMass = m_particles.m_inverseMass[ particleIndex ]; //Pinned particles have 0 inverse mass.
+			accelerationX[ particleIndex ] *= inverseMass;
+			accelerationY[ particleIndex ] *= inverseMass;
+			accelerationZ[ particleIndex ] *= inverseMass;
+		}
+
+		m_particles.IntegrateVerlet( begin, end, deltaSeconds );
+	} );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::StepImplicit( float deltaSeconds )
+{
+	if ( m_useAerodynamics )
+		m_aerodynamics.ComputeTriangleForces( m_particles, m_threadPool );
+	ParallelForAwakeParticles( [ this ]( unsigned int begin, unsigned int end )
+	{
+		CalcParticleForces( begin, end ); //Asleep particles are held by the solve, so their forces don't matter.
+	} );
+
+	double startSeconds = GetCurrentTimeSeconds();
+	double squaredStretch = m_implicitSolver.Step( m_particles, GetSolveBatches(), deltaSeconds, m_threadPool );
+
+	ClothSolveRecord& solveRecord = m_solveHistory[ m_newestSolveRecord ];
+	solveRecord.m_numIterations += m_implicitSolver.GetNumIterationsLastStep();
+	solveRecord.m_residual = squaredStretch; //Same measure as the projection solvers': summed squared error over live constraints.
+	solveRecord.m_milliseconds += ( GetCurrentTimeSeconds() - startSeconds ) * 1000.0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::CalcParticleForces( unsigned int begin, unsigned int end )
+{
+	float* forceX = m_particles.m_accelerationX.data();
+	float* forceY = m_particles.m_accelerationY.data();
+	float* forceZ = m_particles.m_accelerationZ.data();
+	m_forceFields.CalcNetForces( begin, end, m_particleMass,
+								 m_particles.m_positionX.data(), m_particles.m_positionY.data(), m_particles.m_positionZ.data(),
+								 m_particles.m_velocityX.data(), m_particles.m_velocityY.data(), m_particles.m_velocityZ.data(),
+								 forceX, forceY, forceZ );
+	if ( m_useAerodynamics )
+		m_aerodynamics.AddParticleForces( begin, end, forceX, forceY, forceZ );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::UpdateParticleVelocities( float deltaSeconds )
+{
+	ParallelForAwakeParticles( [ this, deltaSeconds ]( unsigned int begin, unsigned int end )
+	{
+		m_particles.UpdateVelocitiesFromPositions( begin, end, deltaSeconds );
+	} );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SatisfyConstraints( float deltaSeconds )
+{
+	double startSeconds = GetCurrentTimeSeconds();
+
+	unsigned int numIterations = m_numConstraintSolverIterations;
+	if ( m_solverType == CLOTH_SOLVER_XPBD )
+	{
+		numIterations = 1;
+		for ( ClothConstraintBatch& batch : GetSolveBatches() )
+			batch.m_lambdas.assign( batch.m_constraints.size(), 0.f );
+	}
+
+	if ( m_useHierarchicalSolver ) //Coarse levels first, so the fine passes only have local error left to remove.
+		m_hierarchy.Solve( m_particles, m_numHierarchyIterationsPerLevel, m_threadPool );
+
+	//norm is the summed squared error, so compare it against tolerance^2 * restLength^2 per live constraint (RMS strain under tolerance).
+	double toleranceDistance = m_solverTolerance * m_baseDistanceBetweenParticles;
+	double maxConvergedNorm = toleranceDistance * toleranceDistance * m_clothConstraints.GetNumConstraints();
+	unsigned int numIteration = 0;
+	double norm = 0.0;
+	if ( m_solverType == CLOTH_SOLVER_JACOBI )
+	{
+		//Chebyshev semi-iterative weights: 1 during the delay, then 2 / ( 2 - rho^2 ), then 4 / ( 4 - rho^2 * previous weight ).
+		m_previousIterateX = m_particles.m_positionX;
+		m_previousIterateY = m_particles.m_positionY;
+		m_previousIterateZ = m_particles.m_positionZ;
+		float rhoSquared = m_chebyshevSpectralRadius * m_chebyshevSpectralRadius;
+		float chebyshevWeight = 1.f;
+		while ( numIteration < numIterations )
+		{
+			if ( numIteration < CHEBYSHEV_DELAY_ITERATIONS || rhoSquared <= 0.f )
+				chebyshevWeight = 1.f;
+			else if ( numIteration == CHEBYSHEV_DELAY_ITERATIONS )
+				chebyshevWeight = 2.f / ( 2.f - rhoSquared );
+			else
+				chebyshevWeight = 4.f / ( 4.f - ( rhoSquared * chebyshevWeight ) );
+
+			norm = SolveJacobiIteration( deltaSeconds, chebyshevWeight );
+			++numIteration;
+			if ( norm <= maxConvergedNorm )
+				break;
+		}
+	}
+	else
+	{
+		//Gauss-Seidel over batches. A batch's constraints touch disjoint particles, so one batch can be split across threads in any order.
+		//The norm is measured as each batch is projected, so it's the error going into the pass: the pass that finds it small enough still runs.
+		while ( numIteration < numIterations )
+		{
+			norm = 0.0;
+			for ( ClothConstraintBatch& batch : GetSolveBatches() )
+				norm += SolveConstraintBatch( batch, deltaSeconds );
+			++numIteration;
+			if ( norm <= maxConvergedNorm )
+				break;
+		}
+	}
+
+	ClothSolveRecord& solveRecord = m_solveHistory[ m_newestSolveRecord ];
+	solveRecord.m_numIterations += numIteration;
+	solveRecord.m_residual = norm;
+	solveRecord.m_milliseconds += ( GetCurrentTimeSeconds() - startSeconds ) * 1000.0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+double Cloth::SolveJacobiIteration( float deltaSeconds, float chebyshevWeight )
+{
+	//Pass 1, per constraint: every correction reads the same iterate, so constraints can run in any order, with no coloring.
+	const float stiffness = PBD_STIFFNESS_PER_SECOND * deltaSeconds;
+	const unsigned int numConstraintIDs = m_clothConstraints.GetNumConstraintIDs();
+	m_jacobiCorrectionX.resize( numConstraintIDs );
+	m_jacobiCorrectionY.resize( numConstraintIDs );
+	m_jacobiCorrectionZ.resize( numConstraintIDs );
+	m_chunkErrors.assign( ( numConstraintIDs + CONSTRAINTS_PER_TASK - 1 ) / CONSTRAINTS_PER_TASK, 0.0 );
+	ThreadPool::ParallelFor( m_threadPool, numConstraintIDs, CONSTRAINTS_PER_TASK, [ this, stiffness ]( unsigned int begin, unsigned int end )
+	{
+		double error = 0.0;
+		for ( unsigned int constraintID = begin; constraintID < end; constraintID++ )
+		{
+			m_jacobiCorrectionX[ constraintID ] = 0.f;
+			m_jacobiCorrectionY[ constraintID ] = 0.f;
+			m_jacobiCorrectionZ[ constraintID ] = 0.f;
+			if ( m_clothConstraints.IsConstraintRemoved( constraintID ) )
+				continue;
+
+			const ClothConstraint& cc = m_clothConstraints.GetConstraint( constraintID );
+			float totalInverseMass = m_particles.m_inverseMass[ cc.p1 ] + m_particles.m_inverseMass[ cc.p2 ];
+			float dx = m_particles.m_positionX[ cc.p2 ] - m_particles.m_positionX[ cc.p1 ];
+			float dy = m_particles.m_positionY[ cc.p2 ] - m_particles.m_positionY[ cc.p1 ];
+			float dz = m_particles.m_positionZ[ cc.p2 ] - m_particles.m_positionZ[ cc.p1 ];
+			float currentDistance = sqrtf( ( dx * dx ) + ( dy * dy ) + ( dz * dz ) );
+			float violation = currentDistance - cc.restDistance;
+			error += violation * violation;
+			if ( currentDistance == 0.f || totalInverseMass == 0.f )
+				continue;
+
+			float scale = stiffness * violation / ( currentDistance * totalInverseMass );
+			m_jacobiCorrectionX[ constraintID ] = dx * scale;
+			m_jacobiCorrectionY[ constraintID ] = dy * scale;
+			m_jacobiCorrectionZ[ constraintID ] = dz * scale;
+		}
+		m_chunkErrors[ begin / CONSTRAINTS_PER_TASK ] = error;
+	} );
+
+	//Pass 2, per particle: gather corrections in adjacency order (a fixed order, so sums don't depend on thread count), average them,
+	//then extrapolate from the previous iterate by the Chebyshev weight. Each particle writes only itself.
+	ThreadPool::ParallelFor( m_threadPool, m_particles.GetNumParticles(), PARTICLES_PER_TASK, [ this, chebyshevWeight ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int particleIndex = begin; particleIndex < end; particleIndex++ )
+		{
+			float x = m_particles.m_positionX[ particleIndex ];
+			float y = m_particles.m_positionY[ particleIndex ];
+			float z = m_particles.m_positionZ[ particleIndex ];
+			float inverseMass = m_particles.m_inverseMass[ particleIndex ];
+			if ( inverseMass == 0.f )
+				continue; //Never moves, so its previous iterate is already its position.
+
+			float sumX = 0.f;
+			float sumY = 0.f;
+			float sumZ = 0.f;
+			unsigned int numCorrections = 0;
+			unsigned int adjacencyEnd = m_clothConstraints.GetAdjacencyEnd( particleIndex );
+			for ( unsigned int adjacencyIndex = m_clothConstraints.GetAdjacencyBegin( particleIndex ); adjacencyIndex < adjacencyEnd; ++adjacencyIndex )
+			{
+				unsigned int constraintID = m_clothConstraints.GetAdjacentConstraintID( adjacencyIndex );
+				if ( m_clothConstraints.IsConstraintRemoved( constraintID ) )
+					continue;
+
+				float sign = ( m_clothConstraints.GetConstraint( constraintID ).p1 == particleIndex ) ? 1.f : -1.f;
+				sumX += sign * m_jacobiCorrectionX[ constraintID ];
+				sumY += sign * m_jacobiCorrectionY[ constraintID ];
+				sumZ += sign * m_jacobiCorrectionZ[ constraintID ];
+				++numCorrections;
+			}
+
+			float targetX = x;
+			float targetY = y;
+			float targetZ = z;
+			if ( numCorrections > 0 )
+			{
+				float scale = inverseMass * JACOBI_RELAXATION / static_cast<float>( numCorrections );
+				targetX += sumX * scale;
+				targetY += sumY * scale;
+				targetZ += sumZ * scale;
+			}
+
+			float previousX = m_previousIterateX[ particleIndex ];
+			float previousY = m_previousIterateY[ particleIndex ];
+			float previousZ = m_previousIterateZ[ particleIndex ];
+			m_particles.m_positionX[ particleIndex ] = previousX + ( chebyshevWeight * ( targetX - previousX ) );
+			m_particles.m_positionY[ particleIndex ] = previousY + ( chebyshevWeight * ( targetY - previousY ) );
+			m_particles.m_positionZ[ particleIndex ] = previousZ + ( chebyshevWeight * ( targetZ - previousZ ) );
+			m_previousIterateX[ particleIndex ] = x;
+			m_previousIterateY[ particleIndex ] = y;
+			m_previousIterateZ[ particleIndex ] = z;
+		}
+	} );
+
+	double error = 0.0;
+	for ( double chunkError : m_chunkErrors )
+		error += chunkError;
+	return error;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+double Cloth::SolveConstraintBatch( ClothConstraintBatch& batch, float deltaSeconds )
+{
+	const unsigned int numConstraints = batch.m_constraints.size();
+	if ( m_threadPool == nullptr || numConstraints <= CONSTRAINTS_PER_TASK )
+		return ProjectConstraintRange( batch, 0, numConstraints, deltaSeconds );
+
+	m_chunkErrors.assign( ( numConstraints + CONSTRAINTS_PER_TASK - 1 ) / CONSTRAINTS_PER_TASK, 0.0 );
+	m_threadPool->ParallelFor( numConstraints, CONSTRAINTS_PER_TASK, [ this, &batch, deltaSeconds ]( unsigned int begin, unsigned int end )
+	{
+		m_chunkErrors[ begin / CONSTRAINTS_PER_TASK ] = ProjectConstraintRange( batch, begin, end, deltaSeconds );
+	} );
+
+	double batchError = 0.0;
+	for ( double chunkError : m_chunkErrors )
+		batchError += chunkError;
+	return batchError;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+double Cloth::ProjectConstraintRange( ClothConstraintBatch& batch, unsigned int begin, unsigned int end, float deltaSeconds )
+{
+	float* positionX = m_particles.m_positionX.data();
+	float* positionY = m_particles.m_positionY.data();
+	float* positionZ = m_particles.m_positionZ.data();
+	const float* inverseMass = m_particles.m_inverseMass.data();
+	const ClothConstraint* constraints = batch.m_constraints.data() + begin;
+
+	if ( m_solverType == CLOTH_SOLVER_XPBD )
+	{
+		float alphaTilde = m_compliance[ batch.m_type ] / ( deltaSeconds * deltaSeconds );
+		return m_xpbdKernel( positionX, positionY, positionZ, inverseMass, constraints, batch.m_lambdas.data() + begin, end - begin, alphaTilde );
+	}
+
+	//Stiffness is applied per unit time. With unit inverse masses each end takes half, and a pinned (zero inverse mass) neighbor leaves the other end the full correction.
+	return m_constraintKernel( positionX, positionY, positionZ, inverseMass, constraints, end - begin, PBD_STIFFNESS_PER_SECOND * deltaSeconds );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Snapshot layout: this header, then per-axis position and displacement arrays, per-particle flags, and the two bitsets.
+struct ClothSnapshotHeader
+{
+	unsigned int m_magic;
+	unsigned int m_numBytes;
+	int m_numRows;
+	int m_numCols;
+	unsigned int m_numConstraintIDs; //0 once every constraint was removed (RemoveAllConstraints), so no constraint bits follow.
+	unsigned int m_numGridCells;
+	unsigned int m_numTornConstraints;
+	float m_accumulatedSeconds;
+	float m_interpolationAlpha;
+	float m_positionMins[ 3 ];
+	float m_positionStep[ 3 ]; //Bounds extent / 65535 per axis: the most quantizing can move a particle is half this.
+	float m_displacementStep[ 3 ]; //Largest |x - x_prev| / 32767 per axis.
+	float m_topLeftPosition[ 3 ];
+};
+static const unsigned int CLOTH_SNAPSHOT_MAGIC = 0x31534C43; //"CLS1": bump the digit whenever the layout changes.
+static const float MAX_QUANTIZED_POSITION = 65535.f;
+static const float MAX_QUANTIZED_DISPLACEMENT = 32767.f;
+
+
+//--------------------------------------------------------------------------------------------------------------
+static size_t CalcSnapshotNumBytes( unsigned int numParticles, unsigned int numConstraintIDs, unsigned int numGridCells )
+{
+	return sizeof( ClothSnapshotHeader )
+		+ ( numParticles * 3 * sizeof( unsigned short ) ) //Positions.
+		+ ( numParticles * 3 * sizeof( short ) ) //Displacements.
+		+ numParticles //Flags.
+		+ ( ( numConstraintIDs + 7 ) / 8 )
+		+ ( ( numGridCells + 7 ) / 8 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SaveSnapshot( std::vector<unsigned char>& out_snapshot ) const
+{
+	unsigned int numParticles = m_particles.GetNumParticles();
+	ClothSnapshotHeader header;
+	header.m_magic = CLOTH_SNAPSHOT_MAGIC;
+	header.m_numRows = m_numRows;
+	header.m_numCols = m_numCols;
+	header.m_numConstraintIDs = ( m_clothConstraints.GetNumConstraintIDs() > 0 ) ? m_clothConstraints.GetNumBuiltConstraintIDs() : 0;
+	header.m_numGridCells = m_mesh.GetNumGridCells();
+	header.m_numTornConstraints = m_numTornConstraints;
+	header.m_accumulatedSeconds = m_accumulatedSeconds;
+	header.m_interpolationAlpha = m_interpolationAlpha;
+	header.m_topLeftPosition[ 0 ] = m_currentTopLeftPosition.x;
+	header.m_topLeftPosition[ 1 ] = m_currentTopLeftPosition.y;
+	header.m_topLeftPosition[ 2 ] = m_currentTopLeftPosition.z;
+	header.m_numBytes = CalcSnapshotNumBytes( numParticles, header.m_numConstraintIDs, header.m_numGridCells );
+	out_snapshot.resize( header.m_numBytes ); //No allocation when the same vector is reused for the same cloth.
+
+	//The header's size is a multiple of 4 and each array an even number of bytes, so the 16-bit arrays stay aligned.
+	unsigned short* quantizedPositions = reinterpret_cast<unsigned short*>( out_snapshot.data() + sizeof( ClothSnapshotHeader ) );
+	short* quantizedDisplacements = reinterpret_cast<short*>( quantizedPositions + ( numParticles * 3 ) );
+	unsigned char* flags = reinterpret_cast<unsigned char*>( quantizedDisplacements + ( numParticles * 3 ) );
+	unsigned char* constraintBits = flags + numParticles;
+	unsigned char* cellBits = constraintBits + ( ( header.m_numConstraintIDs + 7 ) / 8 );
+
+	const std::vector<float>* positions[ 3 ] = { &m_particles.m_positionX, &m_particles.m_positionY, &m_particles.m_positionZ };
+	const std::vector<float>* previousPositions[ 3 ] = { &m_particles.m_previousPositionX, &m_particles.m_previousPositionY, &m_particles.m_previousPositionZ };
+	for ( unsigned int axis = 0; axis < 3; ++axis )
+	{
+		const float* position = positions[ axis ]->data();
+		const float* previousPosition = previousPositions[ axis ]->data();
+		float minPosition = ( numParticles > 0 ) ? position[ 0 ] : 0.f;
+		float maxPosition = minPosition;
+		float maxAbsDisplacement = 0.f;
+		for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+		{
+			minPosition = ( position[ particleIndex ] < minPosition ) ? position[ particleIndex ] : minPosition;
+			maxPosition = ( position[ particleIndex ] > maxPosition ) ? position[ particleIndex ] : maxPosition;
+			float absDisplacement = fabsf( position[ particleIndex ] - previousPosition[ particleIndex ] );
+			maxAbsDisplacement = ( absDisplacement > maxAbsDisplacement ) ? absDisplacement : maxAbsDisplacement;
+		}
+
+		header.m_positionMins[ axis ] = minPosition;
+		header.m_positionStep[ axis ] = ( maxPosition - minPosition ) / MAX_QUANTIZED_POSITION;
+		header.m_displacementStep[ axis ] = maxAbsDisplacement / MAX_QUANTIZED_DISPLACEMENT;
+		float positionScale = ( header.m_positionStep[ axis ] > 0.f ) ? ( 1.f / header.m_positionStep[ axis ] ) : 0.f; //A flat axis stores all zeros.
+		float displacementScale = ( header.m_displacementStep[ axis ] > 0.f ) ? ( 1.f / header.m_displacementStep[ axis ] ) : 0.f;
+
+		unsigned short* quantizedPosition = quantizedPositions + ( axis * numParticles );
+		short* quantizedDisplacement = quantizedDisplacements + ( axis * numParticles );
+		for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+		{
+			float scaledPosition = ( ( position[ particleIndex ] - minPosition ) * positionScale ) + .5f;
+			quantizedPosition[ particleIndex ] = static_cast<unsigned short>( ( scaledPosition < MAX_QUANTIZED_POSITION ) ? scaledPosition : MAX_QUANTIZED_POSITION );
+			float scaledDisplacement = ( position[ particleIndex ] - previousPosition[ particleIndex ] ) * displacementScale;
+			quantizedDisplacement[ particleIndex ] = static_cast<short>( floorf( scaledDisplacement + .5f ) );
+		}
+	}
+
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+		flags[ particleIndex ] = m_particles.m_flags[ particleIndex ];
+	if ( header.m_numConstraintIDs > 0 )
+		m_clothConstraints.WriteLiveConstraintBits( constraintBits );
+	for ( unsigned int cellIndex = 0; cellIndex < header.m_numGridCells; ++cellIndex )
+	{
+		if ( ( cellIndex % 8 ) == 0 )
+			cellBits[ cellIndex / 8 ] = 0;
+		if ( !m_mesh.IsGridCellRemoved( cellIndex ) )
+			cellBits[ cellIndex / 8 ] |= static_cast<unsigned char>( 1 << ( cellIndex % 8 ) );
+	}
+
+	memcpy( out_snapshot.data(), &header, sizeof( ClothSnapshotHeader ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool Cloth::RestoreSnapshot( const std::vector<unsigned char>& snapshot )
+{
+	if ( snapshot.size() < sizeof( ClothSnapshotHeader ) )
+		return false;
+
+	ClothSnapshotHeader header;
+	memcpy( &header, snapshot.data(), sizeof( ClothSnapshotHeader ) );
+	unsigned int numParticles = m_particles.GetNumParticles();
+	bool isFromThisCloth = ( header.m_magic == CLOTH_SNAPSHOT_MAGIC ) && ( header.m_numRows == m_numRows ) && ( header.m_numCols == m_numCols )
+		&& ( header.m_numConstraintIDs == 0 || header.m_numConstraintIDs == m_clothConstraints.GetNumBuiltConstraintIDs() )
+		&& ( header.m_numGridCells == m_mesh.GetNumGridCells() )
+		&& ( header.m_numBytes == snapshot.size() ) && ( header.m_numBytes == CalcSnapshotNumBytes( numParticles, header.m_numConstraintIDs, header.m_numGridCells ) );
+	if ( !isFromThisCloth )
+		return false;
+
+	const unsigned short* quantizedPositions = reinterpret_cast<const unsigned short*>( snapshot.data() + sizeof( ClothSnapshotHeader ) );
+	const short* quantizedDisplacements = reinterpret_cast<const short*>( quantizedPositions + ( numParticles * 3 ) );
+	const unsigned char* flags = reinterpret_cast<const unsigned char*>( quantizedDisplacements + ( numParticles * 3 ) );
+	const unsigned char* constraintBits = flags + numParticles;
+	const unsigned char* cellBits = constraintBits + ( ( header.m_numConstraintIDs + 7 ) / 8 );
+
+	m_sleep.WakeAll( m_particles ); //First, so waking can't write back inverse masses from before the restore.
+	m_tethers.MarkDirty(); //Pins and constraints may both differ from the snapshot's.
+
+	std::vector<float>* positions[ 3 ] = { &m_particles.m_positionX, &m_particles.m_positionY, &m_particles.m_positionZ };
+	std::vector<float>* previousPositions[ 3 ] = { &m_particles.m_previousPositionX, &m_particles.m_previousPositionY, &m_particles.m_previousPositionZ };
+	std::vector<float>* stepStartPositions[ 3 ] = { &m_particles.m_stepStartPositionX, &m_particles.m_stepStartPositionY, &m_particles.m_stepStartPositionZ };
+	std::vector<float>* velocities[ 3 ] = { &m_particles.m_velocityX, &m_particles.m_velocityY, &m_particles.m_velocityZ };
+	for ( unsigned int axis = 0; axis < 3; ++axis )
+	{
+		float* position = positions[ axis ]->data();
+		float* previousPosition = previousPositions[ axis ]->data();
+		float* stepStartPosition = stepStartPositions[ axis ]->data();
+		float* velocity = velocities[ axis ]->data();
+		const unsigned short* quantizedPosition = quantizedPositions + ( axis * numParticles );
+		const short* quantizedDisplacement = quantizedDisplacements + ( axis * numParticles );
+		for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+		{
+			float displacement = quantizedDisplacement[ particleIndex ] * header.m_displacementStep[ axis ];
+			position[ particleIndex ] = header.m_positionMins[ axis ] + ( quantizedPosition[ particleIndex ] * header.m_positionStep[ axis ] );
+			previousPosition[ particleIndex ] = position[ particleIndex ] - displacement; //Verlet reads the velocity back out of x - x_prev.
+			stepStartPosition[ particleIndex ] = position[ particleIndex ]; //Render shows the restored pose as is, instead of lerping in from the old one.
+			velocity[ particleIndex ] = displacement / GetFixedStepSeconds();
+		}
+	}
+
+	m_numExpiredParticles = 0;
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+	{
+		m_particles.m_flags[ particleIndex ] = flags[ particleIndex ];
+		UpdateInverseMass( particleIndex );
+		m_numExpiredParticles += m_particles.IsExpired( particleIndex ) ? 1 : 0;
+	}
+
+	if ( header.m_numConstraintIDs == 0 )
+	{
+		m_clothConstraints.Clear();
+		m_hierarchy.Clear();
+	}
+	else
+	{
+		m_clothConstraints.RestoreLiveConstraints( constraintBits );
+		if ( m_hierarchy.GetNumLevels() == 0 )
+			m_hierarchy.BuildForGrid( m_numRows, m_numCols, static_cast<float>( m_baseDistanceBetweenParticles ) ); //Cleared by RemoveAllConstraints since the save.
+		else
+			m_hierarchy.ClearDamage();
+
+		//Damage isn't saved: it's wherever a particle expired or a constraint tore, which the snapshot already says.
+		for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+		{
+			if ( m_particles.IsExpired( particleIndex ) )
+				m_hierarchy.MarkParticleDamaged( particleIndex / m_numCols, particleIndex % m_numCols );
+		}
+		for ( const ClothConstraintBatch& batch : m_clothConstraints.GetBuiltBatches() )
+		{
+			for ( unsigned int slot = 0; slot < batch.m_constraints.size(); ++slot )
+			{
+				if ( !m_clothConstraints.IsConstraintRemoved( batch.m_constraintIDs[ slot ] ) )
+					continue;
+
+				const ClothConstraint& constraint = batch.m_constraints[ slot ];
+				m_hierarchy.MarkParticleDamaged( constraint.p1 / m_numCols, constraint.p1 % m_numCols );
+				m_hierarchy.MarkParticleDamaged( constraint.p2 / m_numCols, constraint.p2 % m_numCols );
+			}
+		}
+	}
+
+	m_mesh.RestoreAllCells();
+	m_aerodynamics.RestoreAllCells();
+	m_bvh.RestoreAllCells();
+	m_isBvhStale = true;
+	for ( unsigned int cellIndex = 0; cellIndex < header.m_numGridCells; ++cellIndex )
+	{
+		if ( ( cellBits[ cellIndex / 8 ] & ( 1 << ( cellIndex % 8 ) ) ) == 0 )
+			RemoveCell( cellIndex / ( m_numCols - 1 ), cellIndex % ( m_numCols - 1 ) );
+	}
+
+	m_numTornConstraints = header.m_numTornConstraints;
+	m_accumulatedSeconds = header.m_accumulatedSeconds;
+	m_interpolationAlpha = header.m_interpolationAlpha;
+	m_currentTopLeftPosition = Vector3( header.m_topLeftPosition[ 0 ], header.m_topLeftPosition[ 1 ], header.m_topLeftPosition[ 2 ] );
+	return true;
+}
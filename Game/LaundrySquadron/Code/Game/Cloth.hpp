@@ -0,0 +1,278 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include "Engine/Math/Vector3.hpp"
+#include "Game/Physics.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Game/ClothConstraints.hpp"
+#include "Game/ClothConstraintKernels.hpp"
+#include "Game/ClothMesh.hpp"
+#include "Game/ClothHierarchy.hpp"
+#include "Game/ClothSelfCollision.hpp"
+#include "Game/ClothSleep.hpp"
+#include "Game/ClothAerodynamics.hpp"
+#include "Game/ClothImplicitSolver.hpp"
+#include "Game/ClothTethers.hpp"
+#include "Game/ClothBvh.hpp"
+
+
+//-----------------------------------------------------------------------------
+class ThreadPool;
+class Texture;
+
+
+//-----------------------------------------------------------------------------
+enum ClothSolverType
+{
+	CLOTH_SOLVER_PBD, //Stiffness-scaled projection, m_numConstraintSolverIterations passes per step. Sag depends on iterations and timestep.
+	CLOTH_SOLVER_XPBD, //Compliance per ConstraintType, substepped with one pass each. Stiffness is independent of iterations and timestep.
+	CLOTH_SOLVER_JACOBI, //PBD's stiffness, but every constraint reads the same iterate: no coloring or order dependence. Chebyshev-accelerated.
+	CLOTH_SOLVER_IMPLICIT, //Constraints as damped springs, one backward Euler step per 1/60 s solved by conjugate gradient. Springs give under load.
+	NUM_CLOTH_SOLVER_TYPES
+};
+
+
+//-----------------------------------------------------------------------------
+struct ClothSolveRecord //One Update's worth of constraint solving.
+{
+	unsigned int m_numFixedSteps;
+	unsigned int m_numIterations; //Summed over the steps, so a step that stopped early shows up as a lower count.
+	double m_residual; //Squared error seen by the last iteration of the last step.
+	double m_milliseconds; //SatisfyConstraints wall time, summed over the steps.
+};
+
+
+//-----------------------------------------------------------------------------
+class Cloth
+{
+public:
+	//CONTRUCTORS//////////////////////////////////////////////////////////////////////////
+	Cloth( const Vector3& originTopLeftPosition,
+		   ParticleType particleRenderType, float particleMass, float particleRadius,
+		   int numRows, int numCols,
+		   unsigned int numConstraintSolverIterations,
+		   double baseDistanceBetweenParticles,
+		   double ratioDistanceStructuralToShear,
+		   double ratioDistanceStructuralToBend,
+		   const Vector3& initialGlobalVelocity = Vector3::ZERO );
+	~Cloth();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void Update( float deltaSeconds ); //Runs as many fixed steps as deltaSeconds (plus leftover time) covers, up to MAX_FIXED_STEPS_PER_UPDATE.
+	void Render( bool showCloth = true, bool showConstraints = false, bool showParticles = false );
+
+	unsigned int GetParticleIndex( int rowStartTop, int colStartLeft ) const { return ( rowStartTop * m_numCols ) + colStartLeft; } //Row-major.
+	int GetNumRows() const { return m_numRows; }
+	int GetNumCols() const { return m_numCols; }
+	double GetBaseDistanceBetweenParticles() const { return m_baseDistanceBetweenParticles; }
+	float GetParticleMass() const { return m_particleMass; }
+	unsigned int GetNumParticles() const { return m_particles.GetNumParticles(); }
+	Vector3 GetParticlePosition( unsigned int particleIndex ) const { return m_particles.GetPosition( particleIndex ); }
+	Vector3 GetRenderPosition( unsigned int particleIndex ) const { return m_particles.GetInterpolatedPosition( particleIndex, m_interpolationAlpha ); } //Blended between the last two fixed steps.
+	Vector3 GetParticleVelocity( unsigned int particleIndex ) const { return m_particles.GetVelocity( particleIndex ); }
+	bool IsParticleExpired( unsigned int particleIndex ) const { return m_particles.IsExpired( particleIndex ); }
+	unsigned int GetNumExpiredParticles() const { return m_numExpiredParticles; }
+	void SetParticleIsExpired( unsigned int particleIndex, bool newVal ); //An expired particle is no longer held by its pin, and drops constraints to expired neighbors.
+	void SetParticleIsPinned( unsigned int particleIndex, bool newVal ); //Pinned particles get zero inverse mass.
+	void PlaceParticle( unsigned int particleIndex, const Vector3& position, const Vector3& velocity ); //As if it had been moving at velocity through the last step. Wakes its tile.
+
+	bool IsDead() const; //Returns whether the corners still exist.
+	float GetPercentageConstraintsLeft( ConstraintType constraintType = NUM_CONSTRAINT_TYPES ) const;
+	int GetNumConstraints( ConstraintType constraintType = NUM_CONSTRAINT_TYPES ) const;
+
+	void MoveClothByOffset( const Vector3& offset );
+	Vector3 GetCurrentTopLeftPosition() const { return m_currentTopLeftPosition; }
+	Vector3 GetOriginalTopLeftPosition() const { return m_originalTopLeftPosition; }
+	void SetTopLeftPosition( const Vector3& offset ) { m_currentTopLeftPosition = offset; }
+
+	void ResetForces( bool keepGravity = true );
+	void AddForce( Force* force ); //Cloth takes ownership. Stored once in m_forceFields and applied to every particle.
+	void RemoveAllConstraints();
+	void SetThreadPool( ThreadPool* threadPool ) { m_threadPool = threadPool; } //nullptr runs the cloth single-threaded.
+	unsigned int GetNumFixedStepsLastUpdate() const { return m_numFixedStepsLastUpdate; }
+	unsigned int GetNumConstraintColors() const { return m_clothConstraints.GetNumColors(); }
+	void SetSimdLevel( ClothSimdLevel level ); //Clamped to what the CPU supports. CLOTH_SIMD_SCALAR is the reference for correctness checks.
+	ClothSimdLevel GetSimdLevel() const { return m_simdLevel; }
+	void SetSolverType( ClothSolverType solverType ) { m_solverType = solverType; }
+	ClothSolverType GetSolverType() const { return m_solverType; }
+	void SetNumSolverIterations( unsigned int numIterations ) { m_numConstraintSolverIterations = ( numIterations > 0 ) ? numIterations : 1; } //PBD and Jacobi.
+	unsigned int GetNumSolverIterations() const { return m_numConstraintSolverIterations; }
+	void SetChebyshevSpectralRadius( float rho ) { m_chebyshevSpectralRadius = rho; } //Jacobi only. Estimate of the plain Jacobi convergence rate; 0 disables acceleration.
+	float GetChebyshevSpectralRadius() const { return m_chebyshevSpectralRadius; }
+	//PBD and Jacobi stop iterating a step once the RMS strain over live constraints drops below tolerance (0.001 == 0.1% of rest length),
+	//or after GetNumSolverIterations passes. 0 always runs every pass.
+	void SetSolverTolerance( float tolerance ) { m_solverTolerance = tolerance; }
+	float GetSolverTolerance() const { return m_solverTolerance; }
+	double GetLastSolveResidual() const { return GetSolveRecord( 0 ).m_residual; }
+	double GetLastSolveMilliseconds() const { return GetSolveRecord( 0 ).m_milliseconds; }
+	unsigned int GetNumSolveRecords() const { return m_numSolveRecords; } //Of the most recent Updates, up to two seconds' worth.
+	const ClothSolveRecord& GetSolveRecord( unsigned int updatesAgo ) const { return m_solveHistory[ ( m_newestSolveRecord + SOLVE_HISTORY_LENGTH - updatesAgo ) % SOLVE_HISTORY_LENGTH ]; }
+	void SetNumSubsteps( unsigned int numSubsteps ) { m_numSubsteps = ( numSubsteps > 0 ) ? numSubsteps : 1; } //XPBD only.
+	unsigned int GetNumSubsteps() const { return m_numSubsteps; }
+	void SetCompliance( ConstraintType constraintType, float compliance ) { m_compliance[ constraintType ] = compliance; } //XPBD only. Inverse stiffness, 0 == rigid.
+	float GetCompliance( ConstraintType constraintType ) const { return m_compliance[ constraintType ]; }
+	//Implicit only. Spring stiffness in N/m per ConstraintType, spring damping in N*s/m, and the conjugate gradient's cap and tolerance.
+	void SetImplicitStiffness( ConstraintType constraintType, float stiffness ) { m_implicitSolver.SetStiffness( constraintType, stiffness ); }
+	float GetImplicitStiffness( ConstraintType constraintType ) const { return m_implicitSolver.GetStiffness( constraintType ); }
+	void SetImplicitDamping( float damping ) { m_implicitSolver.SetDamping( damping ); }
+	float GetImplicitDamping() const { return m_implicitSolver.GetDamping(); }
+	void SetImplicitMaxIterations( unsigned int maxIterations ) { m_implicitSolver.SetMaxIterations( maxIterations ); }
+	unsigned int GetImplicitMaxIterations() const { return m_implicitSolver.GetMaxIterations(); }
+	void SetImplicitTolerance( float tolerance ) { m_implicitSolver.SetTolerance( tolerance ); }
+	float GetImplicitTolerance() const { return m_implicitSolver.GetTolerance(); }
+	double GetLastImplicitRelativeResidual() const { return m_implicitSolver.GetRelativeResidualLastStep(); }
+	float GetFixedStepSeconds() const { return ( m_solverType == CLOTH_SOLVER_IMPLICIT ) ? IMPLICIT_TIME_STEP_SECONDS : FIXED_TIME_STEP_SECONDS; }
+	//Tethers each free particle to its nearest pin once per step, so pins hold the whole cloth up with few iterations. On by default.
+	void SetUseTethers( bool useTethers ) { m_useTethers = useTethers; }
+	bool IsUsingTethers() const { return m_useTethers; }
+	void SetTetherSlack( float slack ) { m_tethers.SetSlack( slack ); } //Fraction of the rest distance a particle may stray beyond its tether.
+	float GetTetherSlack() const { return m_tethers.GetSlack(); }
+	unsigned int GetNumTethers() const { return m_tethers.GetNumTethers(); } //As of the last step.
+	//Solves coarse levels of the grid before each fine pass, so big grids stop sagging without scaling passes with resolution. Either solver.
+	void SetUseHierarchicalSolver( bool useHierarchy ) { m_useHierarchicalSolver = useHierarchy; }
+	bool IsUsingHierarchicalSolver() const { return m_useHierarchicalSolver; }
+	void SetNumHierarchyIterationsPerLevel( unsigned int numIterations ) { m_numHierarchyIterationsPerLevel = numIterations; }
+	unsigned int GetNumHierarchyIterationsPerLevel() const { return m_numHierarchyIterationsPerLevel; }
+	unsigned int GetNumHierarchyLevels() const { return m_hierarchy.GetNumLevels(); }
+	void SetUseSelfCollision( bool useSelfCollision ) { m_useSelfCollision = useSelfCollision; } //Off by default; costs a spatial hash rebuild per step.
+	bool IsUsingSelfCollision() const { return m_useSelfCollision; }
+	void SetSelfCollisionThickness( float thickness ) { m_selfCollision.SetThickness( thickness ); }
+	float GetSelfCollisionThickness() const { return m_selfCollision.GetThickness(); }
+	unsigned int GetNumSelfCollisionContacts() const { return m_selfCollision.GetNumContactsLastSolve(); }
+	//Constraints of constraintType break once stretched past maxStrain times their rest distance. 0 (the default) never tears.
+	void SetTearStrain( ConstraintType constraintType, float maxStrain ) { m_tearStrain[ constraintType ] = maxStrain; }
+	float GetTearStrain( ConstraintType constraintType ) const { return m_tearStrain[ constraintType ]; }
+	unsigned int GetNumTornConstraints() const { return m_numTornConstraints; } //Since the cloth was built.
+	//Tiles of particles that stay still for a while stop being simulated until something disturbs them. On by default.
+	void SetUseSleep( bool useSleep );
+	bool IsUsingSleep() const { return m_useSleep; }
+	void SetSleepDistance( float sleepDistance ) { m_sleep.SetSleepDistance( sleepDistance ); } //Tiles moving less than this per fixed step count as still.
+	float GetSleepDistance() const { return m_sleep.GetSleepDistance(); }
+	void SetNumStillUpdatesToSleep( unsigned int numUpdates ) { m_sleep.SetNumStillUpdatesToSleep( numUpdates ); }
+	unsigned int GetNumStillUpdatesToSleep() const { return m_sleep.GetNumStillUpdatesToSleep(); }
+	unsigned int GetNumSleepTiles() const { return m_sleep.GetNumTiles(); }
+	unsigned int GetNumSleepingTiles() const { return m_sleep.GetNumSleepingTiles(); }
+	void WakeTilesTouchingSphere( const Vector3& center, float radius ) { m_sleep.WakeTilesTouchingSphere( center, radius, m_particles ); } //E.g. for a projectile about to reach the cloth.
+	//First contact of a sphere swept from start to end with the cloth's drawn triangles, as of the last fixed step; shot-out cells are holes.
+	//Refits the triangle BVH first if the cloth has moved since it was last fitted, so only queried cloths ever pay for it.
+	bool SweepSphere( const Vector3& start, const Vector3& end, float radius, ClothSweepHit& out_hit );
+	//Drag and lift per mesh triangle against the wind, on top of the force fields. Off by default.
+	void SetUseAerodynamics( bool useAerodynamics ) { m_useAerodynamics = useAerodynamics; }
+	bool IsUsingAerodynamics() const { return m_useAerodynamics; }
+	void SetWindVelocity( const Vector3& windVelocity ); //The air's velocity, in m/s. Wakes every tile.
+	Vector3 GetWindVelocity() const { return m_aerodynamics.GetWindVelocity(); }
+	void SetAirDensity( float airDensity ) { m_aerodynamics.SetAirDensity( airDensity ); }
+	float GetAirDensity() const { return m_aerodynamics.GetAirDensity(); }
+	void SetDragCoefficient( float dragCoefficient ) { m_aerodynamics.SetDragCoefficient( dragCoefficient ); }
+	float GetDragCoefficient() const { return m_aerodynamics.GetDragCoefficient(); }
+	void SetLiftCoefficient( float liftCoefficient ) { m_aerodynamics.SetLiftCoefficient( liftCoefficient ); }
+	float GetLiftCoefficient() const { return m_aerodynamics.GetLiftCoefficient(); }
+	//Compact copies of the simulated state: positions quantized to 16 bits within the cloth's bounds, live constraints and mesh cells as bitsets.
+	//Settings (forces, solver, sleep) aren't part of it. Reusing out_snapshot for the same cloth doesn't allocate.
+	void SaveSnapshot( std::vector<unsigned char>& out_snapshot ) const;
+	bool RestoreSnapshot( const std::vector<unsigned char>& snapshot ); //False, changing nothing, if the snapshot came from a cloth of another size.
+
+
+private:
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void AssignParticleStates( float baseDistance, float particleMass, const Vector3& velocity = Vector3::ZERO ); //Note: 0,0 == top-left, so +x is right, +y is down.
+	Vector3 CalcTopRightPosFromTopLeft();
+	void SetDistancesForConstraints( ConstraintType affectedType, double newRestDistance );
+	void AddConstraints( double baseDistance, double ratioStructuralToShear, double ratioStructuralToBend );
+	void SimulateFixedStep( float deltaSeconds );
+	void StepParticles( float deltaSeconds );
+	void StepImplicit( float deltaSeconds );
+	void CalcParticleForces( unsigned int begin, unsigned int end ); //Net force on each particle into m_acceleration, not yet divided by mass.
+	void UpdateParticleVelocities( float deltaSeconds );
+	void UpdateInverseMass( unsigned int particleIndex );
+	void SatisfyConstraints( float deltaSeconds );
+	double SolveConstraintBatch( ClothConstraintBatch& batch, float deltaSeconds );
+	double ProjectConstraintRange( ClothConstraintBatch& batch, unsigned int begin, unsigned int end, float deltaSeconds );
+	double SolveJacobiIteration( float deltaSeconds, float chebyshevWeight );
+	void TearOverstrainedConstraints();
+	void TearConstraint( unsigned int constraintID );
+	void RemoveCell( int rowStartTop, int colStartLeft ); //From the mesh, the aerodynamics and the BVH alike.
+	void ParallelForAwakeParticles( const std::function<void( unsigned int, unsigned int )>& job ); //job gets ranges of awake particle indices.
+	std::vector<ClothConstraintBatch>& GetSolveBatches(); //Every batch, or copies without constraints that are wholly asleep.
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int PARTICLES_PER_TASK = 1024;
+	static const unsigned int AWAKE_RANGES_PER_TASK = 32;
+	static const unsigned int CONSTRAINTS_PER_TASK = 1024;
+	static const float FIXED_TIME_STEP_SECONDS;
+	static const float IMPLICIT_TIME_STEP_SECONDS; //Backward Euler stays stable at a whole frame per step.
+	static const unsigned int MAX_FIXED_STEPS_PER_UPDATE = 8; //Caps the cost of one Update at 8 steps; anything beyond is dropped.
+	static const unsigned int DEFAULT_NUM_SUBSTEPS = 2; //2 x 1 pass already holds shape at least as well as PBD's 5 passes.
+	static const unsigned int DEFAULT_HIERARCHY_ITERATIONS_PER_LEVEL = 2;
+	static const int MIN_SIDE_FOR_HIERARCHY = 64; //Below this, fine passes alone reach across the grid within a step.
+	static const unsigned int CHEBYSHEV_DELAY_ITERATIONS = 2; //Plain Jacobi first; accelerating from the very first iterate overshoots.
+	static const float DEFAULT_CHEBYSHEV_SPECTRAL_RADIUS;
+	static const float JACOBI_RELAXATION; //Scales each particle's averaged correction; > 1 makes up for averaging across its constraints.
+	static const float DEFAULT_SELF_COLLISION_THICKNESS_RATIO; //Of the base distance: under half a cell, so a flat sheet has no contacts.
+	static const float DEFAULT_SOLVER_TOLERANCE;
+	static const float DEFAULT_SLEEP_DISTANCE_RATIO; //Of the base distance.
+	static const unsigned int SOLVE_HISTORY_LENGTH = 120; //Two seconds at 60 Updates a second.
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	Particle m_particleTemplate; //Only used to draw particles via Particle::Render when debugging.
+	Vector3 m_originalTopLeftPosition;
+	Vector3 m_currentTopLeftPosition; //Position of particle (0,0): MOVE THIS WITH WASD TO MOVE PINNED CORNERS!
+	Vector3 m_currentTopRightPosition; //Update whenever WASD event occurs as an optimization, else just recalculating per-tick.
+	int m_numRows;
+	int m_numCols;
+	float m_particleMass;
+	unsigned int m_numConstraintSolverIterations; //Affects soggy: more is less sag.
+	unsigned int m_originalNumConstraints;
+
+	//Ratios stored with class mostly for debugging. Or maybe use > these to tell when break a cloth constraint?
+	double m_baseDistanceBetweenParticles;
+	double m_ratioDistanceStructuralToShear;
+	double m_ratioDistanceStructuralToBend;
+
+	ClothParticleStore m_particles; //Row-major, use GetParticleIndex for 2D row-col interfacing accesses.
+	ForceFieldSet m_forceFields; //Shared by every particle, evaluated straight into the particle store's acceleration arrays.
+	ClothConstraintSet m_clothConstraints; //Each edge once, in contiguous per-type, per-color batches.
+	ThreadPool* m_threadPool; //Batches are solved across this pool; defaults to ThreadPool::instance.
+	std::vector<double> m_chunkErrors; //Per-task squared error, summed in order so the norm doesn't depend on scheduling.
+	ClothSimdLevel m_simdLevel;
+	ConstraintProjectionKernel m_constraintKernel; //Projects a run of one batch, 1, 4 or 8 constraints at a time.
+	XpbdProjectionKernel m_xpbdKernel;
+	ClothSolverType m_solverType;
+	unsigned int m_numSubsteps;
+	float m_compliance[ NUM_CONSTRAINT_TYPES ];
+	float m_tearStrain[ NUM_CONSTRAINT_TYPES ];
+	float m_chebyshevSpectralRadius;
+	ClothImplicitSolver m_implicitSolver;
+	float m_solverTolerance;
+	ClothSolveRecord m_solveHistory[ SOLVE_HISTORY_LENGTH ]; //Ring buffer, written at m_newestSolveRecord once per Update.
+	unsigned int m_newestSolveRecord;
+	unsigned int m_numSolveRecords;
+	std::vector<float> m_jacobiCorrectionX; //Per constraint ID: the correction for p1 per unit inverse mass (p2 takes the negation).
+	std::vector<float> m_jacobiCorrectionY;
+	std::vector<float> m_jacobiCorrectionZ;
+	std::vector<float> m_previousIterateX; //Per particle: the iterate before the current one, which Chebyshev extrapolates from.
+	std::vector<float> m_previousIterateY;
+	std::vector<float> m_previousIterateZ;
+	unsigned int m_numTornConstraints;
+	unsigned int m_numExpiredParticles; //Kept up to date by SetParticleIsExpired and RestoreSnapshot, so nobody has to scan the flags.
+	std::vector<std::vector<unsigned int>> m_chunkTornConstraintIDs; //Per task, appended in order so tears apply in the same order on any thread count.
+	std::vector<unsigned int> m_tornConstraintIDs;
+	float m_accumulatedSeconds; //Real time not yet simulated, always < GetFixedStepSeconds() after Update.
+	float m_interpolationAlpha; //m_accumulatedSeconds / GetFixedStepSeconds(), used by Render.
+	unsigned int m_numFixedStepsLastUpdate;
+	ClothHierarchy m_hierarchy;
+	bool m_useHierarchicalSolver;
+	unsigned int m_numHierarchyIterationsPerLevel;
+	ClothTethers m_tethers;
+	bool m_useTethers;
+	ClothSelfCollision m_selfCollision;
+	bool m_useSelfCollision;
+	ClothSleep m_sleep;
+	bool m_useSleep;
+	ClothAerodynamics m_aerodynamics;
+	bool m_useAerodynamics;
+	ClothBvh m_bvh; //Over the same triangles as m_mesh, for SweepSphere.
+	bool m_isBvhStale; //Particles have moved since the last Refit.
+	ClothMesh m_mesh; //Render-only; the sim never reads it.
+	Texture* m_clothTexture;
+};
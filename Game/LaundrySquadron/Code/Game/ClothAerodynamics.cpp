@@ -0,0 +1,284 @@
+#include "Game/ClothAerodynamics.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cmath>
+
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+	#define CLOTH_AERODYNAMICS_SSE
+	#include <emmintrin.h>
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+const float ClothAerodynamics::DEFAULT_AIR_DENSITY = 1.2f;
+const float ClothAerodynamics::DEFAULT_DRAG_COEFFICIENT = 1.f; //About a flat plate's.
+const float ClothAerodynamics::DEFAULT_LIFT_COEFFICIENT = .5f;
+static const float MIN_LENGTH_SQUARED = 1e-20f; //Keeps still air and collapsed triangles finite; both come out as ~0 force instead of NaN.
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct AerodynamicConstants
+{
+	Vector3 windVelocity;
+	float densityOverTwelve; //.5 * density, over 2 for the cross product's double area, over 3 corners.
+	float dragCoefficient;
+	float liftCoefficient;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Force on each corner of triangle ( a, b, c ) moving at the average of its corners' velocities. See ClothAerodynamics.hpp for the model.
+static Vector3 CalcTriangleCornerForce( const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& averageVelocity, float liveness, const AerodynamicConstants& constants )
+{
+	Vector3 doubleAreaNormal = Vector3::Cross( b - a, c - a );
+	Vector3 relativeAirVelocity = constants.windVelocity - averageVelocity;
+	float flowThroughFace = MathUtils::Dot( doubleAreaNormal, relativeAirVelocity ); //2A * n.u
+	float absFlowThroughFace = fabsf( flowThroughFace );
+	float doubleArea = sqrtf( MathUtils::Dot( doubleAreaNormal, doubleAreaNormal ) + MIN_LENGTH_SQUARED );
+	float airSpeed = sqrtf( MathUtils::Dot( relativeAirVelocity, relativeAirVelocity ) + MIN_LENGTH_SQUARED );
+
+	float scale = constants.densityOverTwelve * liveness;
+	float alongFlow = scale * absFlowThroughFace * ( constants.dragCoefficient - ( constants.liftCoefficient * absFlowThroughFace / ( doubleArea * airSpeed ) ) );
+	float alongNormal = scale * constants.liftCoefficient * flowThroughFace * airSpeed / doubleArea;
+	return ( relativeAirVelocity * alongFlow ) + ( doubleAreaNormal * alongNormal );
+}
+
+
+#if defined( CLOTH_AERODYNAMICS_SSE )
+//--------------------------------------------------------------------------------------------------------------
+struct Vector3x4 //Four Vector3s, one per lane.
+{
+	__m128 x;
+	__m128 y;
+	__m128 z;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline Vector3x4 LoadVector3x4( const float* x, const float* y, const float* z, unsigned int index )
+{
+	Vector3x4 result = { _mm_loadu_ps( x + index ), _mm_loadu_ps( y + index ), _mm_loadu_ps( z + index ) };
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline Vector3x4 Subtract( const Vector3x4& lhs, const Vector3x4& rhs )
+{
+	Vector3x4 result = { _mm_sub_ps( lhs.x, rhs.x ), _mm_sub_ps( lhs.y, rhs.y ), _mm_sub_ps( lhs.z, rhs.z ) };
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 Dot( const Vector3x4& lhs, const Vector3x4& rhs )
+{
+	return _mm_add_ps( _mm_add_ps( _mm_mul_ps( lhs.x, rhs.x ), _mm_mul_ps( lhs.y, rhs.y ) ), _mm_mul_ps( lhs.z, rhs.z ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Lane-wise CalcTriangleCornerForce, same operation order, with full-precision sqrt and divide so SIMD cells match the scalar tail.
+static inline Vector3x4 CalcTriangleCornerForces( const Vector3x4& a, const Vector3x4& b, const Vector3x4& c, const Vector3x4& averageVelocity, __m128 liveness, const AerodynamicConstants& constants )
+{
+	Vector3x4 edge1 = Subtract( b, a );
+	Vector3x4 edge2 = Subtract( c, a );
+	Vector3x4 doubleAreaNormal = { _mm_sub_ps( _mm_mul_ps( edge1.y, edge2.z ), _mm_mul_ps( edge1.z, edge2.y ) ),
+								   _mm_sub_ps( _mm_mul_ps( edge1.z, edge2.x ), _mm_mul_ps( edge1.x, edge2.z ) ),
+								   _mm_sub_ps( _mm_mul_ps( edge1.x, edge2.y ), _mm_mul_ps( edge1.y, edge2.x ) ) };
+	Vector3x4 wind = { _mm_set1_ps( constants.windVelocity.x ), _mm_set1_ps( constants.windVelocity.y ), _mm_set1_ps( constants.windVelocity.z ) };
+	Vector3x4 relativeAirVelocity = Subtract( wind, averageVelocity );
+
+	const __m128 minLengthSquared = _mm_set1_ps( MIN_LENGTH_SQUARED );
+	const __m128 signMask = _mm_set1_ps( -0.f );
+	__m128 flowThroughFace = Dot( doubleAreaNormal, relativeAirVelocity );
+	__m128 absFlowThroughFace = _mm_andnot_ps( signMask, flowThroughFace );
+	__m128 doubleArea = _mm_sqrt_ps( _mm_add_ps( Dot( doubleAreaNormal, doubleAreaNormal ), minLengthSquared ) );
+	__m128 airSpeed = _mm_sqrt_ps( _mm_add_ps( Dot( relativeAirVelocity, relativeAirVelocity ), minLengthSquared ) );
+
+	__m128 scale = _mm_mul_ps( _mm_set1_ps( constants.densityOverTwelve ), liveness );
+	__m128 liftCoefficient = _mm_set1_ps( constants.liftCoefficient );
+	__m128 liftTerm = _mm_div_ps( _mm_mul_ps( liftCoefficient, absFlowThroughFace ), _mm_mul_ps( doubleArea, airSpeed ) );
+	__m128 alongFlow = _mm_mul_ps( _mm_mul_ps( scale, absFlowThroughFace ), _mm_sub_ps( _mm_set1_ps( constants.dragCoefficient ), liftTerm ) );
+	__m128 alongNormal = _mm_div_ps( _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( scale, liftCoefficient ), flowThroughFace ), airSpeed ), doubleArea );
+
+	Vector3x4 result = { _mm_add_ps( _mm_mul_ps( relativeAirVelocity.x, alongFlow ), _mm_mul_ps( doubleAreaNormal.x, alongNormal ) ),
+						 _mm_add_ps( _mm_mul_ps( relativeAirVelocity.y, alongFlow ), _mm_mul_ps( doubleAreaNormal.y, alongNormal ) ),
+						 _mm_add_ps( _mm_mul_ps( relativeAirVelocity.z, alongFlow ), _mm_mul_ps( doubleAreaNormal.z, alongNormal ) ) };
+	return result;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothAerodynamics::ClothAerodynamics()
+	: m_numRows( 0 )
+	, m_numCols( 0 )
+	, m_windVelocity( Vector3::ZERO )
+	, m_airDensity( DEFAULT_AIR_DENSITY )
+	, m_dragCoefficient( DEFAULT_DRAG_COEFFICIENT )
+	, m_liftCoefficient( DEFAULT_LIFT_COEFFICIENT )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothAerodynamics::BuildForGrid( int numRows, int numCols )
+{
+	m_numRows = numRows;
+	m_numCols = numCols;
+
+	unsigned int numPaddedCells = ( numRows + 1 ) * ( numCols + 1 );
+	std::vector<float>* cellArrays[] = { &m_cellLiveness, &m_forceAX, &m_forceAY, &m_forceAZ, &m_forceBX, &m_forceBY, &m_forceBZ };
+	for ( std::vector<float>* cellArray : cellArrays )
+		cellArray->assign( numPaddedCells, 0.f ); //Padding stays 0 forever, so it never contributes.
+	RestoreAllCells();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothAerodynamics::RemoveCell( int rowStartTop, int colStartLeft )
+{
+	if ( rowStartTop < 0 || colStartLeft < 0 || ( rowStartTop + 1 ) >= m_numRows || ( colStartLeft + 1 ) >= m_numCols )
+		return;
+
+	m_cellLiveness[ GetPaddedCellIndex( rowStartTop, colStartLeft ) ] = 0.f;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothAerodynamics::RestoreAllCells()
+{
+	for ( int r = 0; ( r + 1 ) < m_numRows; r++ )
+	{
+		for ( int c = 0; ( c + 1 ) < m_numCols; c++ )
+			m_cellLiveness[ GetPaddedCellIndex( r, c ) ] = 1.f;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothAerodynamics::ComputeTriangleForces( const ClothParticleStore& particles, ThreadPool* threadPool )
+{
+	//Each cell writes only its own slots, so rows of cells split across threads freely.
+	int numCellRows = ( m_numRows > 1 ) ? m_numRows - 1 : 0;
+	ThreadPool::ParallelFor( threadPool, numCellRows, ROWS_PER_TASK, [ this, &particles ]( unsigned int begin, unsigned int end )
+	{
+		ComputeTriangleForcesForRows( particles, begin, end );
+	} );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothAerodynamics::ComputeTriangleForcesForRows( const ClothParticleStore& particles, int firstRow, int endRow )
+{
+	AerodynamicConstants constants;
+	constants.windVelocity = m_windVelocity;
+	constants.densityOverTwelve = m_airDensity / 12.f;
+	constants.dragCoefficient = m_dragCoefficient;
+	constants.liftCoefficient = m_liftCoefficient;
+
+	const float* positionX = particles.m_positionX.data();
+	const float* positionY = particles.m_positionY.data();
+	const float* positionZ = particles.m_positionZ.data();
+	const float* velocityX = particles.m_velocityX.data();
+	const float* velocityY = particles.m_velocityY.data();
+	const float* velocityZ = particles.m_velocityZ.data();
+	const float oneThird = 1.f / 3.f;
+	const int numCellCols = m_numCols - 1;
+
+	for ( int r = firstRow; r < endRow; r++ )
+	{
+		const unsigned int topRowStart = r * m_numCols;
+		const unsigned int bottomRowStart = topRowStart + m_numCols;
+		const unsigned int paddedRowStart = GetPaddedCellIndex( r, 0 );
+		int c = 0;
+
+#if defined( CLOTH_AERODYNAMICS_SSE )
+		//4 cells at a time: each corner of a run of cells is a contiguous run of particles.
+		const __m128 oneThirdx4 = _mm_set1_ps( oneThird );
+		for ( ; c + 4 <= numCellCols; c += 4 )
+		{
+			Vector3x4 topLeft = LoadVector3x4( positionX, positionY, positionZ, topRowStart + c );
+			Vector3x4 topRight = LoadVector3x4( positionX, positionY, positionZ, topRowStart + c + 1 );
+			Vector3x4 bottomLeft = LoadVector3x4( positionX, positionY, positionZ, bottomRowStart + c );
+			Vector3x4 bottomRight = LoadVector3x4( positionX, positionY, positionZ, bottomRowStart + c + 1 );
+			Vector3x4 topLeftVelocity = LoadVector3x4( velocityX, velocityY, velocityZ, topRowStart + c );
+			Vector3x4 topRightVelocity = LoadVector3x4( velocityX, velocityY, velocityZ, topRowStart + c + 1 );
+			Vector3x4 bottomLeftVelocity = LoadVector3x4( velocityX, velocityY, velocityZ, bottomRowStart + c );
+			Vector3x4 bottomRightVelocity = LoadVector3x4( velocityX, velocityY, velocityZ, bottomRowStart + c + 1 );
+
+			//Both triangles share the BL-TR diagonal, so its velocity sum is reused.
+			Vector3x4 diagonalVelocity = { _mm_add_ps( bottomLeftVelocity.x, topRightVelocity.x ), _mm_add_ps( bottomLeftVelocity.y, topRightVelocity.y ), _mm_add_ps( bottomLeftVelocity.z, topRightVelocity.z ) };
+			Vector3x4 averageVelocityA = { _mm_mul_ps( _mm_add_ps( diagonalVelocity.x, bottomRightVelocity.x ), oneThirdx4 ),
+										   _mm_mul_ps( _mm_add_ps( diagonalVelocity.y, bottomRightVelocity.y ), oneThirdx4 ),
+										   _mm_mul_ps( _mm_add_ps( diagonalVelocity.z, bottomRightVelocity.z ), oneThirdx4 ) };
+			Vector3x4 averageVelocityB = { _mm_mul_ps( _mm_add_ps( diagonalVelocity.x, topLeftVelocity.x ), oneThirdx4 ),
+										   _mm_mul_ps( _mm_add_ps( diagonalVelocity.y, topLeftVelocity.y ), oneThirdx4 ),
+										   _mm_mul_ps( _mm_add_ps( diagonalVelocity.z, topLeftVelocity.z ), oneThirdx4 ) };
+
+			__m128 liveness = _mm_loadu_ps( &m_cellLiveness[ paddedRowStart + c ] );
+			Vector3x4 forceA = CalcTriangleCornerForces( bottomLeft, bottomRight, topRight, averageVelocityA, liveness, constants );
+			Vector3x4 forceB = CalcTriangleCornerForces( bottomLeft, topRight, topLeft, averageVelocityB, liveness, constants );
+			_mm_storeu_ps( &m_forceAX[ paddedRowStart + c ], forceA.x );
+			_mm_storeu_ps( &m_forceAY[ paddedRowStart + c ], forceA.y );
+			_mm_storeu_ps( &m_forceAZ[ paddedRowStart + c ], forceA.z );
+			_mm_storeu_ps( &m_forceBX[ paddedRowStart + c ], forceB.x );
+			_mm_storeu_ps( &m_forceBY[ paddedRowStart + c ], forceB.y );
+			_mm_storeu_ps( &m_forceBZ[ paddedRowStart + c ], forceB.z );
+		}
+#endif
+
+		for ( ; c < numCellCols; c++ )
+		{
+			unsigned int topLeft = topRowStart + c;
+			unsigned int topRight = topLeft + 1;
+			unsigned int bottomLeft = bottomRowStart + c;
+			unsigned int bottomRight = bottomLeft + 1;
+			Vector3 diagonalVelocity = particles.GetVelocity( bottomLeft ) + particles.GetVelocity( topRight );
+			Vector3 averageVelocityA = ( diagonalVelocity + particles.GetVelocity( bottomRight ) ) * oneThird;
+			Vector3 averageVelocityB = ( diagonalVelocity + particles.GetVelocity( topLeft ) ) * oneThird;
+
+			float liveness = m_cellLiveness[ paddedRowStart + c ];
+			Vector3 forceA = CalcTriangleCornerForce( particles.GetPosition( bottomLeft ), particles.GetPosition( bottomRight ), particles.GetPosition( topRight ), averageVelocityA, liveness, constants );
+			Vector3 forceB = CalcTriangleCornerForce( particles.GetPosition( bottomLeft ), particles.GetPosition( topRight ), particles.GetPosition( topLeft ), averageVelocityB, liveness, constants );
+			m_forceAX[ paddedRowStart + c ] = forceA.x;
+			m_forceAY[ paddedRowStart + c ] = forceA.y;
+			m_forceAZ[ paddedRowStart + c ] = forceA.z;
+			m_forceBX[ paddedRowStart + c ] = forceB.x;
+			m_forceBY[ paddedRowStart + c ] = forceB.y;
+			m_forceBZ[ paddedRowStart + c ] = forceB.z;
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothAerodynamics::AddParticleForces( unsigned int begin, unsigned int end, float* out_forceX, float* out_forceY, float* out_forceZ ) const
+{
+	//Particle (r,c) is TL of cell (r,c) (in B), TR of cell (r,c-1) (in A and B), BL of cell (r-1,c) (in A and B) and BR of cell (r-1,c-1) (in A).
+	//With the padding those are 4 cells in 2 adjacent rows, all in bounds, so the loop is straight-line within each row.
+	unsigned int particleIndex = begin;
+	while ( particleIndex < end )
+	{
+		int r = particleIndex / m_numCols;
+		int firstCol = particleIndex % m_numCols;
+		int endCol = ( end - ( r * m_numCols ) < static_cast<unsigned int>( m_numCols ) ) ? static_cast<int>( end - ( r * m_numCols ) ) : m_numCols;
+		const unsigned int rowStart = r * m_numCols;
+		const unsigned int belowCells = GetPaddedCellIndex( r, 0 ); //Cells whose top row is r.
+		const unsigned int aboveCells = GetPaddedCellIndex( r - 1, 0 ); //Cells whose bottom row is r.
+
+		for ( int c = firstCol; c < endCol; c++ )
+		{
+			unsigned int right = belowCells + c; //Cell (r,c).
+			unsigned int left = right - 1; //Cell (r,c-1).
+			unsigned int upRight = aboveCells + c; //Cell (r-1,c).
+			unsigned int upLeft = upRight - 1; //Cell (r-1,c-1).
+			out_forceX[ rowStart + c ] += m_forceBX[ right ] + m_forceAX[ left ] + m_forceBX[ left ] + m_forceAX[ upRight ] + m_forceBX[ upRight ] + m_forceAX[ upLeft ];
+			out_forceY[ rowStart + c ] += m_forceBY[ right ] + m_forceAY[ left ] + m_forceBY[ left ] + m_forceAY[ upRight ] + m_forceBY[ upRight ] + m_forceAY[ upLeft ];
+			out_forceZ[ rowStart + c ] += m_forceBZ[ right ] + m_forceAZ[ left ] + m_forceBZ[ left ] + m_forceAZ[ upRight ] + m_forceBZ[ upRight ] + m_forceAZ[ upLeft ];
+		}
+		particleIndex = rowStart + endCol;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include "Engine/Math/Vector3.hpp"
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+//Air drag and lift on a cloth grid, per triangle of the mesh's split (two per cell) rather than per particle as if each were a point.
+//Each triangle sees the air's velocity relative to its average velocity u, with normal n and area A:
+//	drag = .5 * density * Cd * A * |n.u| * u, along the flow;
+//	lift = .5 * density * Cl * A * |n.u| * ( |u| * n' - |n.u| / |u| * u ), across it, where n' is n flipped to face downwind.
+//A third of each goes to each corner. Lift vanishes edge-on and face-on, so a sheet square to the wind only feels drag.
+class ClothAerodynamics
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothAerodynamics();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void BuildForGrid( int numRows, int numCols );
+	void RemoveCell( int rowStartTop, int colStartLeft ); //Cell (r,c) spans particles (r,c) to (r+1,c+1), as in ClothMesh. Removed cells catch no air.
+	void RestoreAllCells();
+	//One sweep over the cells, 4 at a time where SSE is available, from the particles' current positions and velocities.
+	void ComputeTriangleForces( const ClothParticleStore& particles, ThreadPool* threadPool );
+	//Adds each particle's share of its (up to 6) triangles' forces, from the last ComputeTriangleForces. Any range of particle indices.
+	void AddParticleForces( unsigned int begin, unsigned int end, float* out_forceX, float* out_forceY, float* out_forceZ ) const;
+	void SetWindVelocity( const Vector3& windVelocity ) { m_windVelocity = windVelocity; }
+	Vector3 GetWindVelocity() const { return m_windVelocity; }
+	void SetAirDensity( float airDensity ) { m_airDensity = airDensity; }
+	float GetAirDensity() const { return m_airDensity; }
+	void SetDragCoefficient( float dragCoefficient ) { m_dragCoefficient = dragCoefficient; }
+	float GetDragCoefficient() const { return m_dragCoefficient; }
+	void SetLiftCoefficient( float liftCoefficient ) { m_liftCoefficient = liftCoefficient; }
+	float GetLiftCoefficient() const { return m_liftCoefficient; }
+
+
+private:
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const int ROWS_PER_TASK = 16;
+	static const float DEFAULT_AIR_DENSITY; //Sea-level air, in the cloth's mass and length units (kg, m).
+	static const float DEFAULT_DRAG_COEFFICIENT;
+	static const float DEFAULT_LIFT_COEFFICIENT;
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void ComputeTriangleForcesForRows( const ClothParticleStore& particles, int firstRow, int endRow );
+	unsigned int GetPaddedCellIndex( int rowStartTop, int colStartLeft ) const { return ( ( rowStartTop + 1 ) * ( m_numCols + 1 ) ) + colStartLeft + 1; }
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	int m_numRows;
+	int m_numCols;
+	Vector3 m_windVelocity;
+	float m_airDensity;
+	float m_dragCoefficient;
+	float m_liftCoefficient;
+
+	//Per cell, padded with a ring of empty cells so every particle gathers from the same 4 cells without bounds checks.
+	//Triangle A is (BL, BR, TR), triangle B is (BL, TR, TL): the same split ClothMesh draws. Each holds the force on one corner.
+	std::vector<float> m_cellLiveness; //1 for a live cell, 0 for a removed one or padding.
+	std::vector<float> m_forceAX;
+	std::vector<float> m_forceAY;
+	std::vector<float> m_forceAZ;
+	std::vector<float> m_forceBX;
+	std::vector<float> m_forceBY;
+	std::vector<float> m_forceBZ;
+};
@@ -0,0 +1,494 @@
+#include "Game/ClothBvh.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cmath>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const float MIN_LENGTH_SQUARED = 1e-12f; //Below this a sweep, edge or normal is treated as degenerate.
+
+
+//--------------------------------------------------------------------------------------------------------------
+static Vector3 ClosestPointOnTriangle( const Vector3& point, const Vector3 corners[ 3 ], float out_weights[ 3 ] )
+{
+	//By Voronoi region: each corner, then each edge, then the face. Ericson, Real-Time Collision Detection, 5.1.5.
+	Vector3 ab = corners[ 1 ] - corners[ 0 ];
+	Vector3 ac = corners[ 2 ] - corners[ 0 ];
+	Vector3 ap = point - corners[ 0 ];
+	float d1 = MathUtils::Dot( ab, ap );
+	float d2 = MathUtils::Dot( ac, ap );
+	if ( d1 <= 0.f && d2 <= 0.f )
+	{
+		out_weights[ 0 ] = 1.f; out_weights[ 1 ] = 0.f; out_weights[ 2 ] = 0.f;
+		return corners[ 0 ];
+	}
+
+	Vector3 bp = point - corners[ 1 ];
+	float d3 = MathUtils::Dot( ab, bp );
+	float d4 = MathUtils::Dot( ac, bp );
+	if ( d3 >= 0.f && d4 <= d3 )
+	{
+		out_weights[ 0 ] = 0.f; out_weights[ 1 ] = 1.f; out_weights[ 2 ] = 0.f;
+		return corners[ 1 ];
+	}
+
+	float vc = ( d1 * d4 ) - ( d3 * d2 );
+	if ( vc <= 0.f && d1 >= 0.f && d3 <= 0.f )
+	{
+		float v = d1 / ( d1 - d3 );
+		out_weights[ 0 ] = 1.f - v; out_weights[ 1 ] = v; out_weights[ 2 ] = 0.f;
+		return corners[ 0 ] + ( ab * v );
+	}
+
+	Vector3 cp = point - corners[ 2 ];
+	float d5 = MathUtils::Dot( ab, cp );
+	float d6 = MathUtils::Dot( ac, cp );
+	if ( d6 >= 0.f && d5 <= d6 )
+	{
+		out_weights[ 0 ] = 0.f; out_weights[ 1 ] = 0.f; out_weights[ 2 ] = 1.f;
+		return corners[ 2 ];
+	}
+
+	float vb = ( d5 * d2 ) - ( d1 * d6 );
+	if ( vb <= 0.f && d2 >= 0.f && d6 <= 0.f )
+	{
+		float w = d2 / ( d2 - d6 );
+		out_weights[ 0 ] = 1.f - w; out_weights[ 1 ] = 0.f; out_weights[ 2 ] = w;
+		return corners[ 0 ] + ( ac * w );
+	}
+
+	float va = ( d3 * d6 ) - ( d5 * d4 );
+	if ( va <= 0.f && ( d4 - d3 ) >= 0.f && ( d5 - d6 ) >= 0.f )
+	{
+		float w = ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) );
+		out_weights[ 0 ] = 0.f; out_weights[ 1 ] = 1.f - w; out_weights[ 2 ] = w;
+		return corners[ 1 ] + ( ( corners[ 2 ] - corners[ 1 ] ) * w );
+	}
+
+	float denominator = 1.f / ( va + vb + vc );
+	float v = vb * denominator;
+	float w = vc * denominator;
+	out_weights[ 0 ] = 1.f - v - w; out_weights[ 1 ] = v; out_weights[ 2 ] = w;
+	return corners[ 0 ] + ( ab * v ) + ( ac * w );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool CalcBarycentricWeights( const Vector3& pointInPlane, const Vector3 corners[ 3 ], float out_weights[ 3 ] )
+{
+	//Returns whether the point is inside the triangle, edges included.
+	Vector3 ab = corners[ 1 ] - corners[ 0 ];
+	Vector3 ac = corners[ 2 ] - corners[ 0 ];
+	Vector3 ap = pointInPlane - corners[ 0 ];
+	float abab = MathUtils::Dot( ab, ab );
+	float abac = MathUtils::Dot( ab, ac );
+	float acac = MathUtils::Dot( ac, ac );
+	float apab = MathUtils::Dot( ap, ab );
+	float apac = MathUtils::Dot( ap, ac );
+	float inverseDenominator = 1.f / ( ( abab * acac ) - ( abac * abac ) );
+	out_weights[ 1 ] = ( ( acac * apab ) - ( abac * apac ) ) * inverseDenominator;
+	out_weights[ 2 ] = ( ( abab * apac ) - ( abac * apab ) ) * inverseDenominator;
+	out_weights[ 0 ] = 1.f - out_weights[ 1 ] - out_weights[ 2 ];
+	return out_weights[ 0 ] >= 0.f && out_weights[ 1 ] >= 0.f && out_weights[ 2 ] >= 0.f;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool SweepSphereVertex( const Vector3& start, const Vector3& sweep, float radius, const Vector3& vertex, float& inout_time )
+{
+	//|start + t * sweep - vertex| = radius, entering.
+	Vector3 offset = start - vertex;
+	float a = MathUtils::Dot( sweep, sweep );
+	float halfB = MathUtils::Dot( offset, sweep );
+	float c = MathUtils::Dot( offset, offset ) - ( radius * radius );
+	if ( a < MIN_LENGTH_SQUARED || halfB >= 0.f )
+		return false; //Not moving, or moving away.
+
+	float quarterDiscriminant = ( halfB * halfB ) - ( a * c );
+	if ( quarterDiscriminant < 0.f )
+		return false;
+
+	float time = ( -halfB - sqrtf( quarterDiscriminant ) ) / a;
+	if ( time < 0.f || time > inout_time )
+		return false;
+
+	inout_time = time;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool SweepSphereEdge( const Vector3& start, const Vector3& sweep, float radius, const Vector3& edgeStart, const Vector3& edgeEnd, float& inout_time, float& out_edgeFraction )
+{
+	//Distance to the edge's line, with the component along the edge projected out and everything scaled by |edge|^2 to stay division-free:
+	//	|edge|^2 * |m + t*d|^2 - ( ( m + t*d ).edge )^2 = |edge|^2 * radius^2.
+	Vector3 edge = edgeEnd - edgeStart;
+	Vector3 offset = start - edgeStart;
+	float edgeLengthSquared = MathUtils::Dot( edge, edge );
+	if ( edgeLengthSquared < MIN_LENGTH_SQUARED )
+		return false;
+
+	float sweepAlongEdge = MathUtils::Dot( sweep, edge );
+	float offsetAlongEdge = MathUtils::Dot( offset, edge );
+	float a = ( edgeLengthSquared * MathUtils::Dot( sweep, sweep ) ) - ( sweepAlongEdge * sweepAlongEdge );
+	float halfB = ( edgeLengthSquared * MathUtils::Dot( offset, sweep ) ) - ( offsetAlongEdge * sweepAlongEdge );
+	float c = ( edgeLengthSquared * ( MathUtils::Dot( offset, offset ) - ( radius * radius ) ) ) - ( offsetAlongEdge * offsetAlongEdge );
+	if ( a < MIN_LENGTH_SQUARED * edgeLengthSquared || halfB >= 0.f )
+		return false; //Sweeping along the edge (the corners catch that), or moving away from it.
+
+	float quarterDiscriminant = ( halfB * halfB ) - ( a * c );
+	if ( quarterDiscriminant < 0.f )
+		return false;
+
+	float time = ( -halfB - sqrtf( quarterDiscriminant ) ) / a;
+	if ( time < 0.f || time > inout_time )
+		return false;
+
+	float edgeFraction = ( offsetAlongEdge + ( time * sweepAlongEdge ) ) / edgeLengthSquared;
+	if ( edgeFraction < 0.f || edgeFraction > 1.f )
+		return false; //Touches the line past a corner; that corner's own test covers it.
+
+	inout_time = time;
+	out_edgeFraction = edgeFraction;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool SweepSphereTriangle( const Vector3& start, const Vector3& sweep, float radius, const Vector3 corners[ 3 ], float& inout_time, float out_weights[ 3 ] )
+{
+	//Already touching: contact at the start, at the closest point.
+	float weights[ 3 ];
+	Vector3 closestPoint = ClosestPointOnTriangle( start, corners, weights );
+	Vector3 toClosest = closestPoint - start;
+	if ( MathUtils::Dot( toClosest, toClosest ) <= radius * radius )
+	{
+		inout_time = 0.f;
+		out_weights[ 0 ] = weights[ 0 ]; out_weights[ 1 ] = weights[ 1 ]; out_weights[ 2 ] = weights[ 2 ];
+		return true;
+	}
+
+	//The face: the sphere reaches the plane at distance radius, and touches the face if that point of the plane is inside it.
+	Vector3 doubleAreaNormal = Vector3::Cross( corners[ 1 ] - corners[ 0 ], corners[ 2 ] - corners[ 0 ] );
+	float doubleAreaSquared = MathUtils::Dot( doubleAreaNormal, doubleAreaNormal );
+	if ( doubleAreaSquared >= MIN_LENGTH_SQUARED )
+	{
+		Vector3 normal = doubleAreaNormal * ( 1.f / sqrtf( doubleAreaSquared ) );
+		float startDistance = MathUtils::Dot( normal, start - corners[ 0 ] );
+		float sweepDistance = MathUtils::Dot( normal, sweep );
+		if ( startDistance * sweepDistance < 0.f ) //Heading toward the plane from either side.
+		{
+			float side = ( startDistance > 0.f ) ? 1.f : -1.f;
+			float time = ( ( side * radius ) - startDistance ) / sweepDistance;
+			if ( time >= 0.f && time <= inout_time )
+			{
+				Vector3 planePoint = start + ( sweep * time ) - ( normal * ( side * radius ) );
+				if ( CalcBarycentricWeights( planePoint, corners, weights ) )
+				{
+					//Nothing on the triangle can be touched before its face, so this is the first contact.
+					inout_time = time;
+					out_weights[ 0 ] = weights[ 0 ]; out_weights[ 1 ] = weights[ 1 ]; out_weights[ 2 ] = weights[ 2 ];
+					return true;
+				}
+			}
+		}
+	}
+
+	//Missed the face's interior: the earliest of the three edges and three corners.
+	bool isHit = false;
+	for ( unsigned int edgeIndex = 0; edgeIndex < 3; ++edgeIndex )
+	{
+		unsigned int nextIndex = ( edgeIndex + 1 ) % 3;
+		float edgeFraction;
+		if ( SweepSphereEdge( start, sweep, radius, corners[ edgeIndex ], corners[ nextIndex ], inout_time, edgeFraction ) )
+		{
+			out_weights[ 0 ] = 0.f; out_weights[ 1 ] = 0.f; out_weights[ 2 ] = 0.f;
+			out_weights[ edgeIndex ] = 1.f - edgeFraction;
+			out_weights[ nextIndex ] = edgeFraction;
+			isHit = true;
+		}
+	}
+	for ( unsigned int cornerIndex = 0; cornerIndex < 3; ++cornerIndex )
+	{
+		if ( SweepSphereVertex( start, sweep, radius, corners[ cornerIndex ], inout_time ) )
+		{
+			out_weights[ 0 ] = 0.f; out_weights[ 1 ] = 0.f; out_weights[ 2 ] = 0.f;
+			out_weights[ cornerIndex ] = 1.f;
+			isHit = true;
+		}
+	}
+	return isHit;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool SweepSphereBox( const Vector3& start, const Vector3& inverseSweep, const Vector3& sweep, float radius, const float mins[ 3 ], const float maxs[ 3 ], float maxTime )
+{
+	//Slabs of the box grown by radius. Growing the corners square instead of round only lets a few extra leaves through.
+	const float starts[ 3 ] = { start.x, start.y, start.z };
+	const float sweeps[ 3 ] = { sweep.x, sweep.y, sweep.z };
+	const float inverseSweeps[ 3 ] = { inverseSweep.x, inverseSweep.y, inverseSweep.z };
+	if ( mins[ 0 ] > maxs[ 0 ] )
+		return false; //Empty: every cell under it is removed.
+
+	float entryTime = 0.f;
+	float exitTime = maxTime;
+	for ( unsigned int axis = 0; axis < 3; ++axis )
+	{
+		float slabMin = mins[ axis ] - radius;
+		float slabMax = maxs[ axis ] + radius;
+		if ( sweeps[ axis ] == 0.f )
+		{
+			if ( starts[ axis ] < slabMin || starts[ axis ] > slabMax )
+				return false;
+			continue;
+		}
+
+		float time1 = ( slabMin - starts[ axis ] ) * inverseSweeps[ axis ];
+		float time2 = ( slabMax - starts[ axis ] ) * inverseSweeps[ axis ];
+		if ( time1 > time2 )
+		{
+			float swap = time1;
+			time1 = time2;
+			time2 = swap;
+		}
+		entryTime = ( time1 > entryTime ) ? time1 : entryTime;
+		exitTime = ( time2 < exitTime ) ? time2 : exitTime;
+		if ( entryTime > exitTime )
+			return false;
+	}
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ClothSweepHit::GetNearestParticleIndex() const
+{
+	unsigned int nearestCorner = 0;
+	for ( unsigned int cornerIndex = 1; cornerIndex < 3; ++cornerIndex )
+	{
+		if ( m_barycentricWeights[ cornerIndex ] > m_barycentricWeights[ nearestCorner ] )
+			nearestCorner = cornerIndex;
+	}
+	return m_particleIndices[ nearestCorner ];
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothBvh::ClothBvh()
+	: m_numRows( 0 )
+	, m_numCols( 0 )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothBvh::BuildForGrid( int numRows, int numCols )
+{
+	m_numRows = numRows;
+	m_numCols = numCols;
+	m_nodes.clear();
+	m_leafNodes.clear();
+	m_cellOrder.clear();
+
+	int numCellRows = ( numRows > 1 ) ? numRows - 1 : 0;
+	int numCellCols = ( numCols > 1 ) ? numCols - 1 : 0;
+	m_isCellRemoved.assign( numCellRows * numCellCols, 0 );
+	if ( numCellRows > 0 && numCellCols > 0 )
+		BuildNode( 0, numCellRows, 0, numCellCols );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ClothBvh::BuildNode( int firstRow, int endRow, int firstCol, int endCol )
+{
+	unsigned int nodeIndex = m_nodes.size();
+	m_nodes.push_back( Node() );
+	Node& node = m_nodes.back();
+	node.m_secondChild = 0;
+	node.m_firstCell = 0;
+	node.m_numCells = 0;
+
+	int numBlockRows = endRow - firstRow;
+	int numBlockCols = endCol - firstCol;
+	if ( static_cast<unsigned int>( numBlockRows * numBlockCols ) <= MAX_CELLS_PER_LEAF )
+	{
+		node.m_firstCell = m_cellOrder.size();
+		node.m_numCells = numBlockRows * numBlockCols;
+		for ( int r = firstRow; r < endRow; r++ )
+		{
+			for ( int c = firstCol; c < endCol; c++ )
+				m_cellOrder.push_back( ( r * ( m_numCols - 1 ) ) + c );
+		}
+		m_leafNodes.push_back( nodeIndex );
+		return nodeIndex;
+	}
+
+	//Halve the longer side, so blocks stay close to square and their boxes tight.
+	unsigned int secondChild;
+	if ( numBlockRows >= numBlockCols )
+	{
+		int middleRow = firstRow + ( numBlockRows / 2 );
+		BuildNode( firstRow, middleRow, firstCol, endCol );
+		secondChild = BuildNode( middleRow, endRow, firstCol, endCol );
+	}
+	else
+	{
+		int middleCol = firstCol + ( numBlockCols / 2 );
+		BuildNode( firstRow, endRow, firstCol, middleCol );
+		secondChild = BuildNode( firstRow, endRow, middleCol, endCol );
+	}
+	m_nodes[ nodeIndex ].m_secondChild = secondChild; //node may have moved as the children were pushed.
+	return nodeIndex;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothBvh::RemoveCell( int rowStartTop, int colStartLeft )
+{
+	if ( rowStartTop < 0 || colStartLeft < 0 || ( rowStartTop + 1 ) >= m_numRows || ( colStartLeft + 1 ) >= m_numCols )
+		return;
+
+	m_isCellRemoved[ ( rowStartTop * ( m_numCols - 1 ) ) + colStartLeft ] = 1; //Its leaf's box shrinks at the next Refit.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothBvh::RestoreAllCells()
+{
+	m_isCellRemoved.assign( m_isCellRemoved.size(), 0 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothBvh::GetCellTriangle( unsigned int cellIndex, unsigned int triangleInCell, unsigned int out_particleIndices[ 3 ] ) const
+{
+	//Triangle 0 is (BL, BR, TR), triangle 1 is (BL, TR, TL): the same split ClothMesh draws.
+	unsigned int row = cellIndex / ( m_numCols - 1 );
+	unsigned int col = cellIndex % ( m_numCols - 1 );
+	unsigned int topLeft = ( row * m_numCols ) + col;
+	unsigned int topRight = topLeft + 1;
+	unsigned int bottomLeft = topLeft + m_numCols;
+	unsigned int bottomRight = bottomLeft + 1;
+	out_particleIndices[ 0 ] = bottomLeft;
+	out_particleIndices[ 1 ] = ( triangleInCell == 0 ) ? bottomRight : topRight;
+	out_particleIndices[ 2 ] = ( triangleInCell == 0 ) ? topRight : topLeft;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothBvh::RefitLeaf( Node& leaf, const ClothParticleStore& particles ) const
+{
+	float mins[ 3 ] = { INFINITY, INFINITY, INFINITY };
+	float maxs[ 3 ] = { -INFINITY, -INFINITY, -INFINITY };
+	for ( unsigned int cellSlot = leaf.m_firstCell; cellSlot < leaf.m_firstCell + leaf.m_numCells; ++cellSlot )
+	{
+		unsigned int cellIndex = m_cellOrder[ cellSlot ];
+		if ( m_isCellRemoved[ cellIndex ] )
+			continue;
+
+		unsigned int topLeft = ( ( cellIndex / ( m_numCols - 1 ) ) * m_numCols ) + ( cellIndex % ( m_numCols - 1 ) );
+		const unsigned int cornerIndices[ 4 ] = { topLeft, topLeft + 1, topLeft + m_numCols, topLeft + m_numCols + 1 };
+		for ( unsigned int particleIndex : cornerIndices )
+		{
+			const float position[ 3 ] = { particles.m_positionX[ particleIndex ], particles.m_positionY[ particleIndex ], particles.m_positionZ[ particleIndex ] };
+			for ( unsigned int axis = 0; axis < 3; ++axis )
+			{
+				mins[ axis ] = ( position[ axis ] < mins[ axis ] ) ? position[ axis ] : mins[ axis ];
+				maxs[ axis ] = ( position[ axis ] > maxs[ axis ] ) ? position[ axis ] : maxs[ axis ];
+			}
+		}
+	}
+
+	for ( unsigned int axis = 0; axis < 3; ++axis )
+	{
+		leaf.m_mins[ axis ] = mins[ axis ];
+		leaf.m_maxs[ axis ] = maxs[ axis ];
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothBvh::Refit( const ClothParticleStore& particles, ThreadPool* threadPool )
+{
+	ThreadPool::ParallelFor( threadPool, m_leafNodes.size(), LEAVES_PER_TASK, [ this, &particles ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int leafIndex = begin; leafIndex < end; leafIndex++ )
+			RefitLeaf( m_nodes[ m_leafNodes[ leafIndex ] ], particles );
+	} );
+
+	//Children always come after their parent, so walking backward finishes both children before their parent.
+	for ( unsigned int nodeIndex = m_nodes.size(); nodeIndex-- > 0; )
+	{
+		Node& node = m_nodes[ nodeIndex ];
+		if ( node.m_numCells > 0 )
+			continue;
+
+		const Node& firstChild = m_nodes[ nodeIndex + 1 ];
+		const Node& secondChild = m_nodes[ node.m_secondChild ];
+		for ( unsigned int axis = 0; axis < 3; ++axis )
+		{
+			node.m_mins[ axis ] = ( firstChild.m_mins[ axis ] < secondChild.m_mins[ axis ] ) ? firstChild.m_mins[ axis ] : secondChild.m_mins[ axis ];
+			node.m_maxs[ axis ] = ( firstChild.m_maxs[ axis ] > secondChild.m_maxs[ axis ] ) ? firstChild.m_maxs[ axis ] : secondChild.m_maxs[ axis ];
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ClothBvh::SweepSphere( const Vector3& start, const Vector3& end, float radius, const ClothParticleStore& particles, ClothSweepHit& out_hit ) const
+{
+	if ( m_nodes.empty() )
+		return false;
+
+	Vector3 sweep = end - start;
+	Vector3 inverseSweep( ( sweep.x != 0.f ) ? 1.f / sweep.x : 0.f, ( sweep.y != 0.f ) ? 1.f / sweep.y : 0.f, ( sweep.z != 0.f ) ? 1.f / sweep.z : 0.f );
+	float bestTime = 1.f;
+	bool isHit = false;
+
+	unsigned int nodeStack[ MAX_DEPTH ];
+	unsigned int stackSize = 0;
+	nodeStack[ stackSize++ ] = 0;
+	while ( stackSize > 0 )
+	{
+		const unsigned int nodeIndex = nodeStack[ --stackSize ];
+		const Node& node = m_nodes[ nodeIndex ];
+		if ( !SweepSphereBox( start, inverseSweep, sweep, radius, node.m_mins, node.m_maxs, bestTime ) )
+			continue; //Either missed, or can only be reached after the best hit so far.
+
+		if ( node.m_numCells == 0 )
+		{
+			nodeStack[ stackSize++ ] = node.m_secondChild;
+			nodeStack[ stackSize++ ] = nodeIndex + 1;
+			continue;
+		}
+
+		for ( unsigned int cellSlot = node.m_firstCell; cellSlot < node.m_firstCell + node.m_numCells; ++cellSlot )
+		{
+			unsigned int cellIndex = m_cellOrder[ cellSlot ];
+			if ( m_isCellRemoved[ cellIndex ] )
+				continue;
+
+			for ( unsigned int triangleInCell = 0; triangleInCell < 2; ++triangleInCell )
+			{
+				unsigned int particleIndices[ 3 ];
+				GetCellTriangle( cellIndex, triangleInCell, particleIndices );
+				const Vector3 corners[ 3 ] = { particles.GetPosition( particleIndices[ 0 ] ), particles.GetPosition( particleIndices[ 1 ] ), particles.GetPosition( particleIndices[ 2 ] ) };
+				float weights[ 3 ];
+				if ( !SweepSphereTriangle( start, sweep, radius, corners, bestTime, weights ) )
+					continue;
+
+				isHit = true;
+				out_hit.m_time = bestTime;
+				out_hit.m_position = ( corners[ 0 ] * weights[ 0 ] ) + ( corners[ 1 ] * weights[ 1 ] ) + ( corners[ 2 ] * weights[ 2 ] );
+				for ( unsigned int cornerIndex = 0; cornerIndex < 3; ++cornerIndex )
+				{
+					out_hit.m_particleIndices[ cornerIndex ] = particleIndices[ cornerIndex ];
+					out_hit.m_barycentricWeights[ cornerIndex ] = weights[ cornerIndex ];
+				}
+			}
+		}
+	}
+	return isHit;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include "Engine/Math/Vector3.hpp"
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+struct ClothSweepHit //First contact of a swept sphere with a cloth triangle.
+{
+	float m_time; //Fraction of the sweep, 0 at its start and 1 at its end, when the sphere first touches the triangle.
+	Vector3 m_position; //Where it touches, on the triangle: the sum of each corner's position times its weight.
+	unsigned int m_particleIndices[ 3 ]; //The triangle's corners.
+	float m_barycentricWeights[ 3 ]; //Per corner, summing to 1.
+	unsigned int GetNearestParticleIndex() const; //The corner the contact is closest to, by weight.
+};
+
+
+//-----------------------------------------------------------------------------
+//Bounding volume hierarchy over a cloth grid's triangles, the same two per cell ClothMesh draws. The tree is built once from
+//the grid itself, halving the longer side of a block of cells until a block fits in a leaf, so neighbours in the cloth stay
+//neighbours in the tree however the cloth deforms. That lets Refit just recompute the boxes bottom-up from the particles instead
+//of rebuilding, and keeps the boxes tight enough for SweepSphere to visit a handful of leaves rather than every triangle.
+class ClothBvh
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothBvh();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void BuildForGrid( int numRows, int numCols );
+	void RemoveCell( int rowStartTop, int colStartLeft ); //Cell (r,c) spans particles (r,c) to (r+1,c+1), as in ClothMesh. Removed cells are holes.
+	void RestoreAllCells();
+	//Leaves in parallel across threadPool (may be nullptr), then the inner nodes in reverse build order, which visits children first.
+	void Refit( const ClothParticleStore& particles, ThreadPool* threadPool );
+	//Sweeps a sphere from start to end against the live triangles as of the last Refit. Returns false, leaving out_hit alone,
+	//if it touches none; a sphere touching the cloth at start hits at time 0.
+	bool SweepSphere( const Vector3& start, const Vector3& end, float radius, const ClothParticleStore& particles, ClothSweepHit& out_hit ) const;
+	unsigned int GetNumNodes() const { return m_nodes.size(); }
+
+
+private:
+	struct Node
+	{
+		float m_mins[ 3 ]; //Empty (mins above maxs) when every cell under the node is removed.
+		float m_maxs[ 3 ];
+		unsigned int m_secondChild; //Inner nodes only; the first child always directly follows its parent.
+		unsigned int m_firstCell; //Leaves only: their cells are m_cellOrder[ m_firstCell, m_firstCell + m_numCells ).
+		unsigned int m_numCells; //0 for inner nodes.
+	};
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int MAX_CELLS_PER_LEAF = 4; //8 triangles: box tests and triangle tests cost about the same per leaf.
+	static const unsigned int LEAVES_PER_TASK = 256;
+	static const unsigned int MAX_DEPTH = 64; //Of the query's stack. Halving both sides in turn, a 2^31-cell grid is under 64 deep.
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	unsigned int BuildNode( int firstRow, int endRow, int firstCol, int endCol ); //Over cells [firstRow, endRow) x [firstCol, endCol). Returns its index.
+	void RefitLeaf( Node& leaf, const ClothParticleStore& particles ) const;
+	void GetCellTriangle( unsigned int cellIndex, unsigned int triangleInCell, unsigned int out_particleIndices[ 3 ] ) const;
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	int m_numRows;
+	int m_numCols;
+	std::vector<Node> m_nodes; //Depth first, so every child comes after its parent.
+	std::vector<unsigned int> m_leafNodes; //Indices of the leaves in m_nodes, for the parallel pass of Refit.
+	std::vector<unsigned int> m_cellOrder; //Grid cell indices, ( r * ( numCols - 1 ) ) + c, grouped by leaf.
+	std::vector<unsigned char> m_isCellRemoved; //Per grid cell.
+};
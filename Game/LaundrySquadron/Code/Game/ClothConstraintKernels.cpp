@@ -0,0 +1,519 @@
+#include "Game/ClothConstraintKernels.hpp"
+#include "Game/ClothConstraints.hpp"
+#include <cmath>
+
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+	#define CLOTH_SIMD_X86
+	#include <immintrin.h>
+	#if defined( _MSC_VER )
+		#include <intrin.h>
+		#define CLOTH_TARGET_SSE
+		#define CLOTH_TARGET_AVX2
+	#else
+		#define CLOTH_TARGET_SSE __attribute__(( target( "sse2" ) ))
+		#define CLOTH_TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+	#endif
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+double ProjectDistanceConstraintsScalar( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+										 const ClothConstraint* constraints, unsigned int count, float stiffness )
+{
+	double squaredError = 0.0;
+	for ( unsigned int constraintIndex = 0; constraintIndex < count; constraintIndex++ )
+	{
+		const ClothConstraint& currentConstraint = constraints[ constraintIndex ];
+		const unsigned int p1 = currentConstraint.p1;
+		const unsigned int p2 = currentConstraint.p2;
+
+		float dx = positionX[ p2 ] - positionX[ p1 ];
+		float dy = positionY[ p2 ] - positionY[ p1 ];
+		float dz = positionZ[ p2 ] - positionZ[ p1 ];
+		float distanceSquared = ( dx * dx ) + ( dy * dy ) + ( dz * dz );
+		if ( distanceSquared == 0.f )
+			continue; //Skip solving for a step.
+
+		float currentDistance = sqrtf( distanceSquared );
+		float error = currentConstraint.restDistance - currentDistance;
+		squaredError += error * error;
+
+		float inverseMass1 = inverseMass[ p1 ];
+		float inverseMass2 = inverseMass[ p2 ];
+		float inverseMassSum = inverseMass1 + inverseMass2;
+		if ( inverseMassSum == 0.f )
+			continue; //Both ends pinned, neither needs correction.
+
+		//Move p1 towards p2 and p2 towards p1, each by its share of the inverse mass.
+		float scale = stiffness * ( 1.f - ( currentConstraint.restDistance / currentDistance ) ) / inverseMassSum;
+		float scale1 = scale * inverseMass1;
+		float scale2 = scale * inverseMass2;
+		positionX[ p1 ] += dx * scale1;
+		positionY[ p1 ] += dy * scale1;
+		positionZ[ p1 ] += dz * scale1;
+		positionX[ p2 ] -= dx * scale2;
+		positionY[ p2 ] -= dy * scale2;
+		positionZ[ p2 ] -= dz * scale2;
+	}
+	return squaredError;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+double ProjectDistanceConstraintsXpbdScalar( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+											 const ClothConstraint* constraints, float* lambdas, unsigned int count, float alphaTilde )
+{
+	double squaredError = 0.0;
+	for ( unsigned int constraintIndex = 0; constraintIndex < count; constraintIndex++ )
+	{
+		const ClothConstraint& currentConstraint = constraints[ constraintIndex ];
+		const unsigned int p1 = currentConstraint.p1;
+		const unsigned int p2 = currentConstraint.p2;
+
+		float dx = positionX[ p2 ] - positionX[ p1 ];
+		float dy = positionY[ p2 ] - positionY[ p1 ];
+		float dz = positionZ[ p2 ] - positionZ[ p1 ];
+		float distanceSquared = ( dx * dx ) + ( dy * dy ) + ( dz * dz );
+		if ( distanceSquared == 0.f )
+			continue; //Gradient is undefined, skip solving for a step.
+
+		float currentDistance = sqrtf( distanceSquared );
+		float violation = currentDistance - currentConstraint.restDistance; //C(x).
+		squaredError += violation * violation;
+
+		float inverseMass1 = inverseMass[ p1 ];
+		float inverseMass2 = inverseMass[ p2 ];
+		float inverseMassSum = inverseMass1 + inverseMass2;
+		if ( inverseMassSum == 0.f )
+			continue;
+
+		//dLambda = ( -C - alphaTilde * lambda ) / ( w1 + w2 + alphaTilde ), then each end moves along the unit gradient by w * dLambda.
+		float deltaLambda = ( -violation - ( alphaTilde * lambdas[ constraintIndex ] ) ) / ( inverseMassSum + alphaTilde );
+		lambdas[ constraintIndex ] += deltaLambda;
+
+		float scale = deltaLambda / currentDistance;
+		float scale1 = scale * inverseMass1;
+		float scale2 = scale * inverseMass2;
+		positionX[ p1 ] -= dx * scale1;
+		positionY[ p1 ] -= dy * scale1;
+		positionZ[ p1 ] -= dz * scale1;
+		positionX[ p2 ] += dx * scale2;
+		positionY[ p2 ] += dy * scale2;
+		positionZ[ p2 ] += dz * scale2;
+	}
+	return squaredError;
+}
+
+
+#if defined( CLOTH_SIMD_X86 )
+//--------------------------------------------------------------------------------------------------------------
+CLOTH_TARGET_SSE static double ProjectDistanceConstraintsSSE( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+															  const ClothConstraint* constraints, unsigned int count, float stiffness )
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.f );
+	const __m128 stiffnessLanes = _mm_set1_ps( stiffness );
+	__m128 squaredErrorLanes = zero;
+
+	float newPositions[ 6 ][ 4 ];
+	unsigned int constraintIndex = 0;
+	for ( ; constraintIndex + 4 <= count; constraintIndex += 4 )
+	{
+		const ClothConstraint* c = constraints + constraintIndex;
+		const unsigned int a0 = c[ 0 ].p1, a1 = c[ 1 ].p1, a2 = c[ 2 ].p1, a3 = c[ 3 ].p1;
+		const unsigned int b0 = c[ 0 ].p2, b1 = c[ 1 ].p2, b2 = c[ 2 ].p2, b3 = c[ 3 ].p2;
+
+		//SSE has no gather, so build the lanes by hand.
+		__m128 x1 = _mm_setr_ps( positionX[ a0 ], positionX[ a1 ], positionX[ a2 ], positionX[ a3 ] );
+		__m128 y1 = _mm_setr_ps( positionY[ a0 ], positionY[ a1 ], positionY[ a2 ], positionY[ a3 ] );
+		__m128 z1 = _mm_setr_ps( positionZ[ a0 ], positionZ[ a1 ], positionZ[ a2 ], positionZ[ a3 ] );
+		__m128 x2 = _mm_setr_ps( positionX[ b0 ], positionX[ b1 ], positionX[ b2 ], positionX[ b3 ] );
+		__m128 y2 = _mm_setr_ps( positionY[ b0 ], positionY[ b1 ], positionY[ b2 ], positionY[ b3 ] );
+		__m128 z2 = _mm_setr_ps( positionZ[ b0 ], positionZ[ b1 ], positionZ[ b2 ], positionZ[ b3 ] );
+		__m128 w1 = _mm_setr_ps( inverseMass[ a0 ], inverseMass[ a1 ], inverseMass[ a2 ], inverseMass[ a3 ] );
+		__m128 w2 = _mm_setr_ps( inverseMass[ b0 ], inverseMass[ b1 ], inverseMass[ b2 ], inverseMass[ b3 ] );
+		__m128 rest = _mm_setr_ps( c[ 0 ].restDistance, c[ 1 ].restDistance, c[ 2 ].restDistance, c[ 3 ].restDistance );
+
+		__m128 dx = _mm_sub_ps( x2, x1 );
+		__m128 dy = _mm_sub_ps( y2, y1 );
+		__m128 dz = _mm_sub_ps( z2, z1 );
+		__m128 distanceSquared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) ), _mm_mul_ps( dz, dz ) );
+		__m128 isNonZero = _mm_cmpgt_ps( distanceSquared, zero );
+		__m128 currentDistance = _mm_sqrt_ps( distanceSquared );
+
+		__m128 error = _mm_sub_ps( rest, currentDistance );
+		squaredErrorLanes = _mm_add_ps( squaredErrorLanes, _mm_and_ps( isNonZero, _mm_mul_ps( error, error ) ) );
+
+		__m128 inverseMassSum = _mm_add_ps( w1, w2 );
+		__m128 isSolvable = _mm_and_ps( isNonZero, _mm_cmpgt_ps( inverseMassSum, zero ) );
+
+		//Swap 1 into the lanes we skip so the divides stay finite, then mask their correction to zero.
+		__m128 safeDistance = _mm_or_ps( _mm_and_ps( isSolvable, currentDistance ), _mm_andnot_ps( isSolvable, one ) );
+		__m128 safeInverseMassSum = _mm_or_ps( _mm_and_ps( isSolvable, inverseMassSum ), _mm_andnot_ps( isSolvable, one ) );
+		__m128 scale = _mm_div_ps( _mm_mul_ps( stiffnessLanes, _mm_sub_ps( one, _mm_div_ps( rest, safeDistance ) ) ), safeInverseMassSum );
+		scale = _mm_and_ps( isSolvable, scale );
+
+		__m128 scale1 = _mm_mul_ps( scale, w1 );
+		__m128 scale2 = _mm_mul_ps( scale, w2 );
+		_mm_storeu_ps( newPositions[ 0 ], _mm_add_ps( x1, _mm_mul_ps( dx, scale1 ) ) );
+		_mm_storeu_ps( newPositions[ 1 ], _mm_add_ps( y1, _mm_mul_ps( dy, scale1 ) ) );
+		_mm_storeu_ps( newPositions[ 2 ], _mm_add_ps( z1, _mm_mul_ps( dz, scale1 ) ) );
+		_mm_storeu_ps( newPositions[ 3 ], _mm_sub_ps( x2, _mm_mul_ps( dx, scale2 ) ) );
+		_mm_storeu_ps( newPositions[ 4 ], _mm_sub_ps( y2, _mm_mul_ps( dy, scale2 ) ) );
+		_mm_storeu_ps( newPositions[ 5 ], _mm_sub_ps( z2, _mm_mul_ps( dz, scale2 ) ) );
+
+		//No scatter either. Safe to write back lane by lane because constraints in a batch share no particles.
+		const unsigned int firstIndices[ 4 ] = { a0, a1, a2, a3 };
+		const unsigned int secondIndices[ 4 ] = { b0, b1, b2, b3 };
+		for ( int lane = 0; lane < 4; lane++ )
+		{
+			positionX[ firstIndices[ lane ] ] = newPositions[ 0 ][ lane ];
+			positionY[ firstIndices[ lane ] ] = newPositions[ 1 ][ lane ];
+			positionZ[ firstIndices[ lane ] ] = newPositions[ 2 ][ lane ];
+			positionX[ secondIndices[ lane ] ] = newPositions[ 3 ][ lane ];
+			positionY[ secondIndices[ lane ] ] = newPositions[ 4 ][ lane ];
+			positionZ[ secondIndices[ lane ] ] = newPositions[ 5 ][ lane ];
+		}
+	}
+
+	float squaredErrors[ 4 ];
+	_mm_storeu_ps( squaredErrors, squaredErrorLanes );
+	double squaredError = static_cast<double>( squaredErrors[ 0 ] ) + squaredErrors[ 1 ] + squaredErrors[ 2 ] + squaredErrors[ 3 ];
+
+	return squaredError + ProjectDistanceConstraintsScalar( positionX, positionY, positionZ, inverseMass, constraints + constraintIndex, count - constraintIndex, stiffness );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+CLOTH_TARGET_SSE static double ProjectDistanceConstraintsXpbdSSE( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+																  const ClothConstraint* constraints, float* lambdas, unsigned int count, float alphaTilde )
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.f );
+	const __m128 alphaTildeLanes = _mm_set1_ps( alphaTilde );
+	__m128 squaredErrorLanes = zero;
+
+	float newPositions[ 6 ][ 4 ];
+	unsigned int constraintIndex = 0;
+	for ( ; constraintIndex + 4 <= count; constraintIndex += 4 )
+	{
+		const ClothConstraint* c = constraints + constraintIndex;
+		const unsigned int a0 = c[ 0 ].p1, a1 = c[ 1 ].p1, a2 = c[ 2 ].p1, a3 = c[ 3 ].p1;
+		const unsigned int b0 = c[ 0 ].p2, b1 = c[ 1 ].p2, b2 = c[ 2 ].p2, b3 = c[ 3 ].p2;
+
+		__m128 x1 = _mm_setr_ps( positionX[ a0 ], positionX[ a1 ], positionX[ a2 ], positionX[ a3 ] );
+		__m128 y1 = _mm_setr_ps( positionY[ a0 ], positionY[ a1 ], positionY[ a2 ], positionY[ a3 ] );
+		__m128 z1 = _mm_setr_ps( positionZ[ a0 ], positionZ[ a1 ], positionZ[ a2 ], positionZ[ a3 ] );
+		__m128 x2 = _mm_setr_ps( positionX[ b0 ], positionX[ b1 ], positionX[ b2 ], positionX[ b3 ] );
+		__m128 y2 = _mm_setr_ps( positionY[ b0 ], positionY[ b1 ], positionY[ b2 ], positionY[ b3 ] );
+		__m128 z2 = _mm_setr_ps( positionZ[ b0 ], positionZ[ b1 ], positionZ[ b2 ], positionZ[ b3 ] );
+		__m128 w1 = _mm_setr_ps( inverseMass[ a0 ], inverseMass[ a1 ], inverseMass[ a2 ], inverseMass[ a3 ] );
+		__m128 w2 = _mm_setr_ps( inverseMass[ b0 ], inverseMass[ b1 ], inverseMass[ b2 ], inverseMass[ b3 ] );
+		__m128 rest = _mm_setr_ps( c[ 0 ].restDistance, c[ 1 ].restDistance, c[ 2 ].restDistance, c[ 3 ].restDistance );
+		__m128 lambda = _mm_loadu_ps( lambdas + constraintIndex );
+
+		__m128 dx = _mm_sub_ps( x2, x1 );
+		__m128 dy = _mm_sub_ps( y2, y1 );
+		__m128 dz = _mm_sub_ps( z2, z1 );
+		__m128 distanceSquared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) ), _mm_mul_ps( dz, dz ) );
+		__m128 isNonZero = _mm_cmpgt_ps( distanceSquared, zero );
+		__m128 currentDistance = _mm_sqrt_ps( distanceSquared );
+
+		__m128 violation = _mm_sub_ps( currentDistance, rest );
+		squaredErrorLanes = _mm_add_ps( squaredErrorLanes, _mm_and_ps( isNonZero, _mm_mul_ps( violation, violation ) ) );
+
+		__m128 inverseMassSum = _mm_add_ps( w1, w2 );
+		__m128 isSolvable = _mm_and_ps( isNonZero, _mm_cmpgt_ps( inverseMassSum, zero ) );
+
+		__m128 safeDistance = _mm_or_ps( _mm_and_ps( isSolvable, currentDistance ), _mm_andnot_ps( isSolvable, one ) );
+		__m128 denominator = _mm_add_ps( _mm_or_ps( _mm_and_ps( isSolvable, inverseMassSum ), _mm_andnot_ps( isSolvable, one ) ), alphaTildeLanes );
+		__m128 deltaLambda = _mm_div_ps( _mm_sub_ps( _mm_sub_ps( zero, violation ), _mm_mul_ps( alphaTildeLanes, lambda ) ), denominator );
+		deltaLambda = _mm_and_ps( isSolvable, deltaLambda );
+		_mm_storeu_ps( lambdas + constraintIndex, _mm_add_ps( lambda, deltaLambda ) );
+
+		__m128 scale = _mm_div_ps( deltaLambda, safeDistance );
+		__m128 scale1 = _mm_mul_ps( scale, w1 );
+		__m128 scale2 = _mm_mul_ps( scale, w2 );
+		_mm_storeu_ps( newPositions[ 0 ], _mm_sub_ps( x1, _mm_mul_ps( dx, scale1 ) ) );
+		_mm_storeu_ps( newPositions[ 1 ], _mm_sub_ps( y1, _mm_mul_ps( dy, scale1 ) ) );
+		_mm_storeu_ps( newPositions[ 2 ], _mm_sub_ps( z1, _mm_mul_ps( dz, scale1 ) ) );
+		_mm_storeu_ps( newPositions[ 3 ], _mm_add_ps( x2, _mm_mul_ps( dx, scale2 ) ) );
+		_mm_storeu_ps( newPositions[ 4 ], _mm_add_ps( y2, _mm_mul_ps( dy, scale2 ) ) );
+		_mm_storeu_ps( newPositions[ 5 ], _mm_add_ps( z2, _mm_mul_ps( dz, scale2 ) ) );
+
+		const unsigned int firstIndices[ 4 ] = { a0, a1, a2, a3 };
+		const unsigned int secondIndices[ 4 ] = { b0, b1, b2, b3 };
+		for ( int lane = 0; lane < 4; lane++ )
+		{
+			positionX[ firstIndices[ lane ] ] = newPositions[ 0 ][ lane ];
+			positionY[ firstIndices[ lane ] ] = newPositions[ 1 ][ lane ];
+			positionZ[ firstIndices[ lane ] ] = newPositions[ 2 ][ lane ];
+			positionX[ secondIndices[ lane ] ] = newPositions[ 3 ][ lane ];
+			positionY[ secondIndices[ lane ] ] = newPositions[ 4 ][ lane ];
+			positionZ[ secondIndices[ lane ] ] = newPositions[ 5 ][ lane ];
+		}
+	}
+
+	float squaredErrors[ 4 ];
+	_mm_storeu_ps( squaredErrors, squaredErrorLanes );
+	double squaredError = static_cast<double>( squaredErrors[ 0 ] ) + squaredErrors[ 1 ] + squaredErrors[ 2 ] + squaredErrors[ 3 ];
+
+	return squaredError + ProjectDistanceConstraintsXpbdScalar( positionX, positionY, positionZ, inverseMass, constraints + constraintIndex, lambdas + constraintIndex, count - constraintIndex, alphaTilde );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+CLOTH_TARGET_AVX2 static double ProjectDistanceConstraintsAVX2( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+																const ClothConstraint* constraints, unsigned int count, float stiffness )
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps( 1.f );
+	const __m256 stiffnessLanes = _mm256_set1_ps( stiffness );
+	__m256 squaredErrorLanes = zero;
+
+	int firstIndices[ 8 ];
+	int secondIndices[ 8 ];
+	float restDistances[ 8 ];
+	float newPositions[ 6 ][ 8 ];
+	unsigned int constraintIndex = 0;
+	for ( ; constraintIndex + 8 <= count; constraintIndex += 8 )
+	{
+		const ClothConstraint* c = constraints + constraintIndex;
+		for ( int lane = 0; lane < 8; lane++ )
+		{
+			firstIndices[ lane ] = static_cast<int>( c[ lane ].p1 );
+			secondIndices[ lane ] = static_cast<int>( c[ lane ].p2 );
+			restDistances[ lane ] = c[ lane ].restDistance;
+		}
+		__m256i indices1 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( firstIndices ) );
+		__m256i indices2 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( secondIndices ) );
+
+		__m256 x1 = _mm256_i32gather_ps( positionX, indices1, 4 );
+		__m256 y1 = _mm256_i32gather_ps( positionY, indices1, 4 );
+		__m256 z1 = _mm256_i32gather_ps( positionZ, indices1, 4 );
+		__m256 x2 = _mm256_i32gather_ps( positionX, indices2, 4 );
+		__m256 y2 = _mm256_i32gather_ps( positionY, indices2, 4 );
+		__m256 z2 = _mm256_i32gather_ps( positionZ, indices2, 4 );
+		__m256 w1 = _mm256_i32gather_ps( inverseMass, indices1, 4 );
+		__m256 w2 = _mm256_i32gather_ps( inverseMass, indices2, 4 );
+		__m256 rest = _mm256_loadu_ps( restDistances );
+
+		__m256 dx = _mm256_sub_ps( x2, x1 );
+		__m256 dy = _mm256_sub_ps( y2, y1 );
+		__m256 dz = _mm256_sub_ps( z2, z1 );
+		__m256 distanceSquared = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( dx, dx ), _mm256_mul_ps( dy, dy ) ), _mm256_mul_ps( dz, dz ) );
+		__m256 isNonZero = _mm256_cmp_ps( distanceSquared, zero, _CMP_GT_OQ );
+		__m256 currentDistance = _mm256_sqrt_ps( distanceSquared );
+
+		__m256 error = _mm256_sub_ps( rest, currentDistance );
+		squaredErrorLanes = _mm256_add_ps( squaredErrorLanes, _mm256_and_ps( isNonZero, _mm256_mul_ps( error, error ) ) );
+
+		__m256 inverseMassSum = _mm256_add_ps( w1, w2 );
+		__m256 isSolvable = _mm256_and_ps( isNonZero, _mm256_cmp_ps( inverseMassSum, zero, _CMP_GT_OQ ) );
+
+		__m256 safeDistance = _mm256_blendv_ps( one, currentDistance, isSolvable );
+		__m256 safeInverseMassSum = _mm256_blendv_ps( one, inverseMassSum, isSolvable );
+		__m256 scale = _mm256_div_ps( _mm256_mul_ps( stiffnessLanes, _mm256_sub_ps( one, _mm256_div_ps( rest, safeDistance ) ) ), safeInverseMassSum );
+		scale = _mm256_and_ps( isSolvable, scale );
+
+		__m256 scale1 = _mm256_mul_ps( scale, w1 );
+		__m256 scale2 = _mm256_mul_ps( scale, w2 );
+		_mm256_storeu_ps( newPositions[ 0 ], _mm256_add_ps( x1, _mm256_mul_ps( dx, scale1 ) ) );
+		_mm256_storeu_ps( newPositions[ 1 ], _mm256_add_ps( y1, _mm256_mul_ps( dy, scale1 ) ) );
+		_mm256_storeu_ps( newPositions[ 2 ], _mm256_add_ps( z1, _mm256_mul_ps( dz, scale1 ) ) );
+		_mm256_storeu_ps( newPositions[ 3 ], _mm256_sub_ps( x2, _mm256_mul_ps( dx, scale2 ) ) );
+		_mm256_storeu_ps( newPositions[ 4 ], _mm256_sub_ps( y2, _mm256_mul_ps( dy, scale2 ) ) );
+		_mm256_storeu_ps( newPositions[ 5 ], _mm256_sub_ps( z2, _mm256_mul_ps( dz, scale2 ) ) );
+
+		//AVX2 has no scatter. Safe to write back lane by lane because constraints in a batch share no particles.
+		for ( int lane = 0; lane < 8; lane++ )
+		{
+			positionX[ firstIndices[ lane ] ] = newPositions[ 0 ][ lane ];
+			positionY[ firstIndices[ lane ] ] = newPositions[ 1 ][ lane ];
+			positionZ[ firstIndices[ lane ] ] = newPositions[ 2 ][ lane ];
+			positionX[ secondIndices[ lane ] ] = newPositions[ 3 ][ lane ];
+			positionY[ secondIndices[ lane ] ] = newPositions[ 4 ][ lane ];
+			positionZ[ secondIndices[ lane ] ] = newPositions[ 5 ][ lane ];
+		}
+	}
+
+	float squaredErrors[ 8 ];
+	_mm256_storeu_ps( squaredErrors, squaredErrorLanes );
+	double squaredError = 0.0;
+	for ( int lane = 0; lane < 8; lane++ )
+		squaredError += squaredErrors[ lane ];
+
+	return squaredError + ProjectDistanceConstraintsScalar( positionX, positionY, positionZ, inverseMass, constraints + constraintIndex, count - constraintIndex, stiffness );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+CLOTH_TARGET_AVX2 static double ProjectDistanceConstraintsXpbdAVX2( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+																	const ClothConstraint* constraints, float* lambdas, unsigned int count, float alphaTilde )
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps( 1.f );
+	const __m256 alphaTildeLanes = _mm256_set1_ps( alphaTilde );
+	__m256 squaredErrorLanes = zero;
+
+	int firstIndices[ 8 ];
+	int secondIndices[ 8 ];
+	float restDistances[ 8 ];
+	float newPositions[ 6 ][ 8 ];
+	unsigned int constraintIndex = 0;
+	for ( ; constraintIndex + 8 <= count; constraintIndex += 8 )
+	{
+		const ClothConstraint* c = constraints + constraintIndex;
+		for ( int lane = 0; lane < 8; lane++ )
+		{
+			firstIndices[ lane ] = static_cast<int>( c[ lane ].p1 );
+			secondIndices[ lane ] = static_cast<int>( c[ lane ].p2 );
+			restDistances[ lane ] = c[ lane ].restDistance;
+		}
+		__m256i indices1 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( firstIndices ) );
+		__m256i indices2 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( secondIndices ) );
+
+		__m256 x1 = _mm256_i32gather_ps( positionX, indices1, 4 );
+		__m256 y1 = _mm256_i32gather_ps( positionY, indices1, 4 );
+		__m256 z1 = _mm256_i32gather_ps( positionZ, indices1, 4 );
+		__m256 x2 = _mm256_i32gather_ps( positionX, indices2, 4 );
+		__m256 y2 = _mm256_i32gather_ps( positionY, indices2, 4 );
+		__m256 z2 = _mm256_i32gather_ps( positionZ, indices2, 4 );
+		__m256 w1 = _mm256_i32gather_ps( inverseMass, indices1, 4 );
+		__m256 w2 = _mm256_i32gather_ps( inverseMass, indices2, 4 );
+		__m256 rest = _mm256_loadu_ps( restDistances );
+		__m256 lambda = _mm256_loadu_ps( lambdas + constraintIndex );
+
+		__m256 dx = _mm256_sub_ps( x2, x1 );
+		__m256 dy = _mm256_sub_ps( y2, y1 );
+		__m256 dz = _mm256_sub_ps( z2, z1 );
+		__m256 distanceSquared = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( dx, dx ), _mm256_mul_ps( dy, dy ) ), _mm256_mul_ps( dz, dz ) );
+		__m256 isNonZero = _mm256_cmp_ps( distanceSquared, zero, _CMP_GT_OQ );
+		__m256 currentDistance = _mm256_sqrt_ps( distanceSquared );
+
+		__m256 violation = _mm256_sub_ps( currentDistance, rest );
+		squaredErrorLanes = _mm256_add_ps( squaredErrorLanes, _mm256_and_ps( isNonZero, _mm256_mul_ps( violation, violation ) ) );
+
+		__m256 inverseMassSum = _mm256_add_ps( w1, w2 );
+		__m256 isSolvable = _mm256_and_ps( isNonZero, _mm256_cmp_ps( inverseMassSum, zero, _CMP_GT_OQ ) );
+
+		__m256 safeDistance = _mm256_blendv_ps( one, currentDistance, isSolvable );
+		__m256 denominator = _mm256_add_ps( _mm256_blendv_ps( one, inverseMassSum, isSolvable ), alphaTildeLanes );
+		__m256 deltaLambda = _mm256_div_ps( _mm256_sub_ps( _mm256_sub_ps( zero, violation ), _mm256_mul_ps( alphaTildeLanes, lambda ) ), denominator );
+		deltaLambda = _mm256_and_ps( isSolvable, deltaLambda );
+		_mm256_storeu_ps( lambdas + constraintIndex, _mm256_add_ps( lambda, deltaLambda ) );
+
+		__m256 scale = _mm256_div_ps( deltaLambda, safeDistance );
+		__m256 scale1 = _mm256_mul_ps( scale, w1 );
+		__m256 scale2 = _mm256_mul_ps( scale, w2 );
+		_mm256_storeu_ps( newPositions[ 0 ], _mm256_sub_ps( x1, _mm256_mul_ps( dx, scale1 ) ) );
+		_mm256_storeu_ps( newPositions[ 1 ], _mm256_sub_ps( y1, _mm256_mul_ps( dy, scale1 ) ) );
+		_mm256_storeu_ps( newPositions[ 2 ], _mm256_sub_ps( z1, _mm256_mul_ps( dz, scale1 ) ) );
+		_mm256_storeu_ps( newPositions[ 3 ], _mm256_add_ps( x2, _mm256_mul_ps( dx, scale2 ) ) );
+		_mm256_storeu_ps( newPositions[ 4 ], _mm256_add_ps( y2, _mm256_mul_ps( dy, scale2 ) ) );
+		_mm256_storeu_ps( newPositions[ 5 ], _mm256_add_ps( z2, _mm256_mul_ps( dz, scale2 ) ) );
+
+		for ( int lane = 0; lane < 8; lane++ )
+		{
+			positionX[ firstIndices[ lane ] ] = newPositions[ 0 ][ lane ];
+			positionY[ firstIndices[ lane ] ] = newPositions[ 1 ][ lane ];
+			positionZ[ firstIndices[ lane ] ] = newPositions[ 2 ][ lane ];
+			positionX[ secondIndices[ lane ] ] = newPositions[ 3 ][ lane ];
+			positionY[ secondIndices[ lane ] ] = newPositions[ 4 ][ lane ];
+			positionZ[ secondIndices[ lane ] ] = newPositions[ 5 ][ lane ];
+		}
+	}
+
+	float squaredErrors[ 8 ];
+	_mm256_storeu_ps( squaredErrors, squaredErrorLanes );
+	double squaredError = 0.0;
+	for ( int lane = 0; lane < 8; lane++ )
+		squaredError += squaredErrors[ lane ];
+
+	return squaredError + ProjectDistanceConstraintsXpbdScalar( positionX, positionY, positionZ, inverseMass, constraints + constraintIndex, lambdas + constraintIndex, count - constraintIndex, alphaTilde );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool IsAVX2SupportedByCPU()
+{
+#if defined( _MSC_VER )
+	int cpuInfo[ 4 ];
+	__cpuid( cpuInfo, 0 );
+	if ( cpuInfo[ 0 ] < 7 )
+		return false;
+
+	__cpuid( cpuInfo, 1 );
+	bool isAVXSupported = ( cpuInfo[ 2 ] & ( 1 << 28 ) ) != 0;
+	bool isXSaveEnabledByOS = ( cpuInfo[ 2 ] & ( 1 << 27 ) ) != 0;
+	if ( !isAVXSupported || !isXSaveEnabledByOS )
+		return false;
+	if ( ( _xgetbv( 0 ) & 0x6 ) != 0x6 )
+		return false; //OS doesn't save the YMM registers on context switch.
+
+	__cpuidex( cpuInfo, 7, 0 );
+	return ( cpuInfo[ 1 ] & ( 1 << 5 ) ) != 0;
+#else
+	return __builtin_cpu_supports( "avx2" ) != 0;
+#endif
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothSimdLevel GetBestSupportedClothSimdLevel()
+{
+#if defined( CLOTH_SIMD_X86 )
+	static const ClothSimdLevel s_bestSupportedLevel = IsAVX2SupportedByCPU() ? CLOTH_SIMD_AVX2 : CLOTH_SIMD_SSE; //SSE2 is baseline on every x86 target we build.
+	return s_bestSupportedLevel;
+#else
+	return CLOTH_SIMD_SCALAR;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ConstraintProjectionKernel GetConstraintProjectionKernel( ClothSimdLevel level )
+{
+	if ( level > GetBestSupportedClothSimdLevel() )
+		level = GetBestSupportedClothSimdLevel();
+
+	switch ( level )
+	{
+#if defined( CLOTH_SIMD_X86 )
+	case CLOTH_SIMD_AVX2:	return &ProjectDistanceConstraintsAVX2;
+	case CLOTH_SIMD_SSE:	return &ProjectDistanceConstraintsSSE;
+#endif
+	default:				return &ProjectDistanceConstraintsScalar;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+XpbdProjectionKernel GetXpbdProjectionKernel( ClothSimdLevel level )
+{
+	if ( level > GetBestSupportedClothSimdLevel() )
+		level = GetBestSupportedClothSimdLevel();
+
+	switch ( level )
+	{
+#if defined( CLOTH_SIMD_X86 )
+	case CLOTH_SIMD_AVX2:	return &ProjectDistanceConstraintsXpbdAVX2;
+	case CLOTH_SIMD_SSE:	return &ProjectDistanceConstraintsXpbdSSE;
+#endif
+	default:				return &ProjectDistanceConstraintsXpbdScalar;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+const char* GetClothSimdLevelName( ClothSimdLevel level )
+{
+	switch ( level )
+	{
+	case CLOTH_SIMD_SCALAR:	return "scalar";
+	case CLOTH_SIMD_SSE:	return "sse";
+	case CLOTH_SIMD_AVX2:	return "avx2";
+	default:				return "unknown";
+	}
+}
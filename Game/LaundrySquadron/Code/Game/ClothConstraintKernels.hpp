@@ -0,0 +1,32 @@
+#pragma once
+
+
+//-----------------------------------------------------------------------------
+struct ClothConstraint;
+
+
+//-----------------------------------------------------------------------------
+enum ClothSimdLevel { CLOTH_SIMD_SCALAR, CLOTH_SIMD_SSE, CLOTH_SIMD_AVX2, NUM_CLOTH_SIMD_LEVELS };
+
+
+//-----------------------------------------------------------------------------
+//Projects count distance constraints that share no particles, moving each endpoint by its share of inverse mass.
+//stiffness scales the full correction (1 == satisfy exactly). Returns the summed squared error ( rest - current )^2.
+typedef double ( *ConstraintProjectionKernel )( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+												const ClothConstraint* constraints, unsigned int count, float stiffness );
+
+double ProjectDistanceConstraintsScalar( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+										 const ClothConstraint* constraints, unsigned int count, float stiffness );
+
+//XPBD variant: compliance replaces stiffness. alphaTilde is compliance / ( substep dt )^2, and lambdas holds one Lagrange multiplier
+//per constraint (zeroed at the start of each substep), accumulated in place. Returns the summed squared constraint violation.
+typedef double ( *XpbdProjectionKernel )( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+										  const ClothConstraint* constraints, float* lambdas, unsigned int count, float alphaTilde );
+
+double ProjectDistanceConstraintsXpbdScalar( float* positionX, float* positionY, float* positionZ, const float* inverseMass,
+											 const ClothConstraint* constraints, float* lambdas, unsigned int count, float alphaTilde );
+
+ClothSimdLevel GetBestSupportedClothSimdLevel(); //Checked once against the running CPU.
+ConstraintProjectionKernel GetConstraintProjectionKernel( ClothSimdLevel level ); //Clamps level to what the CPU supports.
+XpbdProjectionKernel GetXpbdProjectionKernel( ClothSimdLevel level ); //Ditto.
+const char* GetClothSimdLevelName( ClothSimdLevel level );
@@ -0,0 +1,302 @@
+#include "Game/ClothConstraints.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::BuildForGrid( int numRows, int numCols, float baseDistance, float shearDistance, float bendDistance )
+{
+	Clear();
+
+	std::vector<ClothConstraint> stretch;
+	std::vector<ClothConstraint> shear;
+	std::vector<ClothConstraint> bend;
+
+	//Exact edge counts for a full grid, so no batch reallocates while building.
+	stretch.reserve( ( numRows * ( numCols - 1 ) ) + ( ( numRows - 1 ) * numCols ) );
+	shear.reserve( 2 * ( numRows - 1 ) * ( numCols - 1 ) );
+	bend.reserve( ( numRows * std::max( numCols - 2, 0 ) ) + ( std::max( numRows - 2, 0 ) * numCols ) );
+
+	//Only look right and down (plus down-left for the second diagonal) so each undirected edge is emitted once.
+	for ( int r = 0; r < numRows; r++ )
+	{
+		for ( int c = 0; c < numCols; c++ )
+		{
+			unsigned int p = ( r * numCols ) + c;
+
+			if ( ( c + 1 ) < numCols )
+				stretch.push_back( ClothConstraint( p, p + 1, baseDistance ) );
+			if ( ( r + 1 ) < numRows )
+				stretch.push_back( ClothConstraint( p, p + numCols, baseDistance ) );
+
+			if ( ( r + 1 ) < numRows && ( c + 1 ) < numCols )
+				shear.push_back( ClothConstraint( p, p + numCols + 1, shearDistance ) );
+			if ( ( r + 1 ) < numRows && ( c - 1 ) >= 0 )
+				shear.push_back( ClothConstraint( p, p + numCols - 1, shearDistance ) );
+
+			if ( ( c + 2 ) < numCols )
+				bend.push_back( ClothConstraint( p, p + 2, bendDistance ) );
+			if ( ( r + 2 ) < numRows )
+				bend.push_back( ClothConstraint( p, p + ( 2 * numCols ), bendDistance ) );
+		}
+	}
+
+	unsigned int numParticles = numRows * numCols;
+	AddColoredBatches( STRETCH, stretch, numParticles );
+	AddColoredBatches( SHEAR, shear, numParticles );
+	AddColoredBatches( BEND, bend, numParticles );
+
+	BuildParticleAdjacency( numParticles );
+	m_builtBatches = m_batches;
+	m_numBuiltConstraintIDs = m_locations.size();
+	m_numParticles = numParticles;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::Clear()
+{
+	m_batches.clear();
+	m_locations.clear();
+	m_adjacencyOffsets.clear();
+	m_adjacentConstraintIDs.clear();
+	for ( unsigned int typeIndex = 0; typeIndex < NUM_CONSTRAINT_TYPES; ++typeIndex )
+		m_numConstraintsOfType[ typeIndex ] = 0;
+	++m_revision;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::AddColoredBatches( ConstraintType type, const std::vector<ClothConstraint>& constraints, unsigned int numParticles )
+{
+	//Greedy coloring: give each constraint the lowest color neither endpoint already uses within this type.
+	//The builder walks the grid in row-major order, which keeps this at <= 8 colors per type for a regular grid.
+	const unsigned int MAX_COLORS = 64;
+	std::vector<unsigned long long> usedColorsPerParticle( numParticles, 0 );
+	unsigned int firstBatchIndex = m_batches.size();
+
+	for ( const ClothConstraint& constraint : constraints )
+	{
+		unsigned long long usedColors = usedColorsPerParticle[ constraint.p1 ] | usedColorsPerParticle[ constraint.p2 ];
+		unsigned int color = 0;
+		while ( color < MAX_COLORS && ( usedColors & ( 1ull << color ) ) != 0 )
+			++color;
+		ASSERT_OR_DIE( color < MAX_COLORS, "Cloth constraint graph needs more colors than a particle mask can hold." );
+
+		usedColorsPerParticle[ constraint.p1 ] |= ( 1ull << color );
+		usedColorsPerParticle[ constraint.p2 ] |= ( 1ull << color );
+
+		while ( m_batches.size() <= firstBatchIndex + color )
+			m_batches.push_back( ClothConstraintBatch( type, m_batches.size() - firstBatchIndex ) );
+
+		ClothConstraintBatch& batch = m_batches[ firstBatchIndex + color ];
+		ConstraintLocation location = { firstBatchIndex + color, static_cast<unsigned int>( batch.m_constraints.size() ) };
+		batch.m_constraintIDs.push_back( m_locations.size() );
+		batch.m_constraints.push_back( constraint );
+		m_locations.push_back( location );
+	}
+	m_numConstraintsOfType[ type ] += constraints.size();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::BuildParticleAdjacency( unsigned int numParticles )
+{
+	//Counting sort into CSR form: one flat ID array, no per-particle allocations.
+	m_adjacencyOffsets.assign( numParticles + 1, 0 );
+	for ( const ClothConstraintBatch& batch : m_batches )
+	{
+		for ( const ClothConstraint& constraint : batch.m_constraints )
+		{
+			++m_adjacencyOffsets[ constraint.p1 + 1 ];
+			++m_adjacencyOffsets[ constraint.p2 + 1 ];
+		}
+	}
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+		m_adjacencyOffsets[ particleIndex + 1 ] += m_adjacencyOffsets[ particleIndex ];
+
+	m_adjacentConstraintIDs.resize( m_adjacencyOffsets[ numParticles ] );
+	std::vector<unsigned int> nextSlot( m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1 );
+	for ( const ClothConstraintBatch& batch : m_batches )
+	{
+		for ( unsigned int slot = 0; slot < batch.m_constraints.size(); ++slot )
+		{
+			const ClothConstraint& constraint = batch.m_constraints[ slot ];
+			m_adjacentConstraintIDs[ nextSlot[ constraint.p1 ]++ ] = batch.m_constraintIDs[ slot ];
+			m_adjacentConstraintIDs[ nextSlot[ constraint.p2 ]++ ] = batch.m_constraintIDs[ slot ];
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::RemoveConstraint( unsigned int constraintID )
+{
+	//Swap-remove: order within a batch doesn't matter, since its constraints share no particles.
+	ConstraintLocation& location = m_locations[ constraintID ];
+	ClothConstraintBatch& batch = m_batches[ location.batchIndex ];
+	unsigned int lastSlot = batch.m_constraints.size() - 1;
+
+	batch.m_constraints[ location.slot ] = batch.m_constraints[ lastSlot ];
+	batch.m_constraintIDs[ location.slot ] = batch.m_constraintIDs[ lastSlot ];
+	m_locations[ batch.m_constraintIDs[ location.slot ] ].slot = location.slot;
+	batch.m_constraints.pop_back();
+	batch.m_constraintIDs.pop_back();
+	if ( batch.m_lambdas.size() > lastSlot )
+	{
+		batch.m_lambdas[ location.slot ] = batch.m_lambdas[ lastSlot ];
+		batch.m_lambdas.pop_back();
+	}
+
+	--m_numConstraintsOfType[ batch.m_type ];
+	location.batchIndex = INVALID_INDEX;
+	++m_revision;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ClothConstraintSet::GetNumColors( ConstraintType constraintType /*= NUM_CONSTRAINT_TYPES*/ ) const
+{
+	unsigned int count = 0;
+	for ( const ClothConstraintBatch& batch : m_batches )
+	{
+		if ( constraintType == NUM_CONSTRAINT_TYPES || constraintType == batch.m_type )
+			++count;
+	}
+	return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ClothConstraintSet::GetNumConstraints( ConstraintType constraintType /*= NUM_CONSTRAINT_TYPES*/ ) const
+{
+	if ( constraintType != NUM_CONSTRAINT_TYPES )
+		return m_numConstraintsOfType[ constraintType ];
+
+	return m_numConstraintsOfType[ STRETCH ] + m_numConstraintsOfType[ SHEAR ] + m_numConstraintsOfType[ BEND ];
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::SetRestDistanceForType( ConstraintType affectedType, float newRestDistance )
+{
+	for ( ClothConstraintBatch& batch : m_batches )
+	{
+		if ( batch.m_type != affectedType )
+			continue;
+
+		for ( ClothConstraint& constraint : batch.m_constraints )
+			constraint.restDistance = newRestDistance;
+	}
+	for ( ClothConstraintBatch& batch : m_builtBatches )
+	{
+		if ( batch.m_type != affectedType )
+			continue;
+
+		for ( ClothConstraint& constraint : batch.m_constraints )
+			constraint.restDistance = newRestDistance;
+	}
+	++m_revision;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::RemoveConstraintsBetweenExpiredParticles( unsigned int particleIndex, const ClothParticleStore& particles )
+{
+	if ( m_adjacencyOffsets.empty() )
+		return; //Cleared, nothing left to remove.
+
+	for ( unsigned int adjacencyIndex = m_adjacencyOffsets[ particleIndex ]; adjacencyIndex < m_adjacencyOffsets[ particleIndex + 1 ]; ++adjacencyIndex )
+	{
+		unsigned int constraintID = m_adjacentConstraintIDs[ adjacencyIndex ];
+		const ConstraintLocation& location = m_locations[ constraintID ];
+		if ( location.batchIndex == INVALID_INDEX )
+			continue; //Already removed via its other end.
+
+		const ClothConstraint& cc = m_batches[ location.batchIndex ].m_constraints[ location.slot ];
+		if ( particles.IsExpired( cc.p1 ) && particles.IsExpired( cc.p2 ) ) // Tried to do || instead, creates awkward stretching...
+			RemoveConstraint( constraintID );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ClothConstraintSet::AreParticlesConnected( unsigned int p1, unsigned int p2 ) const
+{
+	if ( m_adjacencyOffsets.empty() )
+		return false;
+
+	for ( unsigned int adjacencyIndex = m_adjacencyOffsets[ p1 ]; adjacencyIndex < m_adjacencyOffsets[ p1 + 1 ]; ++adjacencyIndex )
+	{
+		const ConstraintLocation& location = m_locations[ m_adjacentConstraintIDs[ adjacencyIndex ] ];
+		if ( location.batchIndex == INVALID_INDEX )
+			continue;
+
+		const ClothConstraint& cc = m_batches[ location.batchIndex ].m_constraints[ location.slot ];
+		if ( cc.p1 == p2 || cc.p2 == p2 )
+			return true;
+	}
+	return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ClothConstraintSet::HasConstraints( unsigned int particleIndex ) const
+{
+	if ( m_adjacencyOffsets.empty() )
+		return false;
+
+	for ( unsigned int adjacencyIndex = m_adjacencyOffsets[ particleIndex ]; adjacencyIndex < m_adjacencyOffsets[ particleIndex + 1 ]; ++adjacencyIndex )
+	{
+		if ( m_locations[ m_adjacentConstraintIDs[ adjacencyIndex ] ].batchIndex != INVALID_INDEX )
+			return true;
+	}
+	return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::WriteLiveConstraintBits( unsigned char* out_bits ) const
+{
+	unsigned int numBytes = ( m_numBuiltConstraintIDs + 7 ) / 8;
+	for ( unsigned int byteIndex = 0; byteIndex < numBytes; ++byteIndex )
+		out_bits[ byteIndex ] = 0;
+
+	for ( unsigned int constraintID = 0; constraintID < m_locations.size(); ++constraintID )
+	{
+		if ( m_locations[ constraintID ].batchIndex != INVALID_INDEX )
+			out_bits[ constraintID / 8 ] |= static_cast<unsigned char>( 1 << ( constraintID % 8 ) );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothConstraintSet::RestoreLiveConstraints( const unsigned char* bits )
+{
+	//Assigning batch by batch reuses the vectors' capacity, so this is copies, not allocations, once the set has held everything before.
+	m_batches = m_builtBatches;
+	m_locations.resize( m_numBuiltConstraintIDs );
+	for ( unsigned int typeIndex = 0; typeIndex < NUM_CONSTRAINT_TYPES; ++typeIndex )
+		m_numConstraintsOfType[ typeIndex ] = 0;
+	for ( unsigned int batchIndex = 0; batchIndex < m_batches.size(); ++batchIndex )
+	{
+		const ClothConstraintBatch& batch = m_batches[ batchIndex ];
+		for ( unsigned int slot = 0; slot < batch.m_constraintIDs.size(); ++slot )
+		{
+			ConstraintLocation location = { batchIndex, slot };
+			m_locations[ batch.m_constraintIDs[ slot ] ] = location;
+		}
+		m_numConstraintsOfType[ batch.m_type ] += batch.m_constraints.size();
+	}
+	if ( m_adjacencyOffsets.empty() )
+		BuildParticleAdjacency( m_numParticles );
+
+	//Swap-removes leave a batch in a different order than before, which doesn't change results: a batch's constraints share no particles.
+	for ( unsigned int constraintID = 0; constraintID < m_numBuiltConstraintIDs; ++constraintID )
+	{
+		if ( ( bits[ constraintID / 8 ] & ( 1 << ( constraintID % 8 ) ) ) == 0 )
+			RemoveConstraint( constraintID );
+	}
+	++m_revision;
+}
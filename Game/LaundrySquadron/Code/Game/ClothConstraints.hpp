@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+
+
+//-----------------------------------------------------------------------------
+enum ConstraintType { STRETCH, SHEAR, BEND, NUM_CONSTRAINT_TYPES };
+struct ClothConstraint
+{
+	unsigned int p1; //Indices into the cloth's particle store.
+	unsigned int p2;
+	float restDistance; //How far apart p1, p2 are when cloth at rest.
+	ClothConstraint( unsigned int p1, unsigned int p2, float restDistance )
+		: p1( p1 ), p2( p2 ), restDistance( restDistance ) {}
+};
+
+
+//-----------------------------------------------------------------------------
+struct ClothConstraintBatch //A contiguous run of constraints that all share one type and one color.
+{
+	ClothConstraintBatch( ConstraintType type, unsigned int color )
+		: m_type( type )
+		, m_color( color )
+	{
+	}
+
+	ConstraintType m_type;
+	unsigned int m_color; //No two constraints in a batch share a particle, so a batch can be solved in parallel.
+	std::vector<ClothConstraint> m_constraints;
+	std::vector<float> m_lambdas; //XPBD Lagrange multipliers, parallel to m_constraints. Only valid within one substep.
+	std::vector<unsigned int> m_constraintIDs; //Parallel to m_constraints, so a swap-remove can fix up the moved constraint's location.
+};
+
+
+//-----------------------------------------------------------------------------
+class ClothConstraintSet
+{
+public:
+
+	ClothConstraintSet() : m_revision( 0 ), m_numBuiltConstraintIDs( 0 ), m_numParticles( 0 ) { Clear(); }
+
+	//Emits every grid edge exactly once, grouped into batches by type (STRETCH, then SHEAR, then BEND), then by color within each type.
+	void BuildForGrid( int numRows, int numCols, float baseDistance, float shearDistance, float bendDistance );
+	void Clear();
+	unsigned int GetNumConstraints( ConstraintType constraintType = NUM_CONSTRAINT_TYPES ) const; //O(1), counts are kept as constraints are removed.
+	void SetRestDistanceForType( ConstraintType affectedType, float newRestDistance );
+	//Call once when particleIndex expires: removes its constraints whose other end has expired too. O(degree of the particle).
+	void RemoveConstraintsBetweenExpiredParticles( unsigned int particleIndex, const ClothParticleStore& particles );
+	unsigned int GetNumColors( ConstraintType constraintType = NUM_CONSTRAINT_TYPES ) const;
+	bool AreParticlesConnected( unsigned int p1, unsigned int p2 ) const; //Whether a live constraint joins them. O(degree of p1).
+	bool HasConstraints( unsigned int particleIndex ) const; //Whether any live constraint touches it. O(degree of the particle).
+	unsigned int GetRevision() const { return m_revision; } //Changes whenever a constraint is removed or edited, so copies of the batches can tell they're stale.
+	//Constraint IDs are stable for the set's lifetime (see ClothConstraintBatch::m_constraintIDs); removal is O(1).
+	const ClothConstraint& GetConstraint( unsigned int constraintID ) const { return m_batches[ m_locations[ constraintID ].batchIndex ].m_constraints[ m_locations[ constraintID ].slot ]; }
+	ConstraintType GetConstraintType( unsigned int constraintID ) const { return m_batches[ m_locations[ constraintID ].batchIndex ].m_type; }
+	bool IsConstraintRemoved( unsigned int constraintID ) const { return m_locations[ constraintID ].batchIndex == INVALID_INDEX; }
+	void RemoveConstraint( unsigned int constraintID );
+	unsigned int GetNumConstraintIDs() const { return m_locations.size(); } //Removed IDs included, so this bounds every ID ever handed out.
+	//Particle p's constraint IDs (removed ones included) are GetAdjacentConstraintID( i ) for i in [ GetAdjacencyBegin( p ), GetAdjacencyEnd( p ) ).
+	unsigned int GetAdjacencyBegin( unsigned int particleIndex ) const { return m_adjacencyOffsets.empty() ? 0 : m_adjacencyOffsets[ particleIndex ]; }
+	unsigned int GetAdjacencyEnd( unsigned int particleIndex ) const { return m_adjacencyOffsets.empty() ? 0 : m_adjacencyOffsets[ particleIndex + 1 ]; }
+	unsigned int GetAdjacentConstraintID( unsigned int adjacencyIndex ) const { return m_adjacentConstraintIDs[ adjacencyIndex ]; }
+	//Snapshots: bit ID is set for each live constraint, in ( GetNumBuiltConstraintIDs() + 7 ) / 8 bytes.
+	unsigned int GetNumBuiltConstraintIDs() const { return m_numBuiltConstraintIDs; } //As of the last BuildForGrid, still known after a Clear.
+	const std::vector<ClothConstraintBatch>& GetBuiltBatches() const { return m_builtBatches; } //Every constraint, as BuildForGrid left them.
+	void WriteLiveConstraintBits( unsigned char* out_bits ) const;
+	void RestoreLiveConstraints( const unsigned char* bits ); //Copies the built batches back, then removes the constraints whose bits are clear. Works after a Clear too.
+
+	std::vector<ClothConstraintBatch> m_batches;
+
+
+private:
+
+	struct ConstraintLocation
+	{
+		unsigned int batchIndex; //INVALID_INDEX once removed.
+		unsigned int slot;
+	};
+
+	void AddColoredBatches( ConstraintType type, const std::vector<ClothConstraint>& constraints, unsigned int numParticles );
+	void BuildParticleAdjacency( unsigned int numParticles );
+
+	static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+	std::vector<ConstraintLocation> m_locations; //Indexed by constraint ID, which never changes after BuildForGrid.
+	std::vector<unsigned int> m_adjacencyOffsets; //Particle p's constraint IDs are m_adjacentConstraintIDs[ offsets[ p ], offsets[ p + 1 ] ).
+	std::vector<unsigned int> m_adjacentConstraintIDs;
+	unsigned int m_numConstraintsOfType[ NUM_CONSTRAINT_TYPES ];
+	unsigned int m_revision;
+	std::vector<ClothConstraintBatch> m_builtBatches; //Kept through Clear, so restoring never has to rebuild or recolor.
+	unsigned int m_numBuiltConstraintIDs;
+	unsigned int m_numParticles;
+};
@@ -0,0 +1,277 @@
+#include "Game/ClothHierarchy.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include <cmath>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void BuildCoarseIndexes( int numFine, int stride, std::vector<int>& out_fineOfCoarse )
+{
+	out_fineOfCoarse.clear();
+	for ( int fine = 0; fine < numFine; fine += stride )
+		out_fineOfCoarse.push_back( fine );
+	if ( out_fineOfCoarse.back() != numFine - 1 )
+		out_fineOfCoarse.push_back( numFine - 1 ); //Keep the far edge, it holds a pinned corner.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void BuildFineLookup( int numFine, const std::vector<int>& fineOfCoarse, std::vector<int>& out_coarseBefore, std::vector<float>& out_weight )
+{
+	out_coarseBefore.resize( numFine );
+	out_weight.resize( numFine );
+
+	int numCoarseIntervals = fineOfCoarse.size() - 1;
+	int coarse = 0;
+	for ( int fine = 0; fine < numFine; fine++ )
+	{
+		while ( coarse < numCoarseIntervals - 1 && fine >= fineOfCoarse[ coarse + 1 ] )
+			++coarse;
+
+		out_coarseBefore[ fine ] = coarse;
+		out_weight[ fine ] = (float)( fine - fineOfCoarse[ coarse ] ) / (float)( fineOfCoarse[ coarse + 1 ] - fineOfCoarse[ coarse ] ); //Exactly 0 or 1 on coarse nodes.
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothHierarchy::ClothHierarchy()
+	: m_numRows( 0 )
+	, m_numCols( 0 )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothHierarchy::BuildForGrid( int numRows, int numCols, float baseDistance )
+{
+	m_numRows = numRows;
+	m_numCols = numCols;
+	m_levels.clear();
+
+	for ( int stride = 2; m_levels.size() < MAX_LEVELS; stride *= 2 )
+	{
+		int numCoarseRows = ( ( numRows - 1 ) / stride ) + 1 + ( ( ( numRows - 1 ) % stride != 0 ) ? 1 : 0 );
+		int numCoarseCols = ( ( numCols - 1 ) / stride ) + 1 + ( ( ( numCols - 1 ) % stride != 0 ) ? 1 : 0 );
+		if ( numCoarseRows < MIN_NODES_PER_SIDE || numCoarseCols < MIN_NODES_PER_SIDE )
+			break;
+
+		m_levels.push_back( Level() );
+		BuildLevel( m_levels.back(), stride, baseDistance );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothHierarchy::BuildLevel( Level& level, int stride, float baseDistance )
+{
+	BuildCoarseIndexes( m_numRows, stride, level.m_fineRowOfCoarseRow );
+	BuildCoarseIndexes( m_numCols, stride, level.m_fineColOfCoarseCol );
+	BuildFineLookup( m_numRows, level.m_fineRowOfCoarseRow, level.m_coarseRowAboveFineRow, level.m_rowWeight );
+	BuildFineLookup( m_numCols, level.m_fineColOfCoarseCol, level.m_coarseColLeftOfFineCol, level.m_colWeight );
+
+	int numCoarseRows = level.m_numCoarseRows = level.m_fineRowOfCoarseRow.size();
+	int numCoarseCols = level.m_numCoarseCols = level.m_fineColOfCoarseCol.size();
+	int numCellCols = numCoarseCols - 1;
+	level.m_numDamagedInCell.assign( ( numCoarseRows - 1 ) * numCellCols, 0 );
+	level.m_nodeDeltaX.resize( numCoarseRows * numCoarseCols );
+	level.m_nodeDeltaY.resize( numCoarseRows * numCoarseCols );
+	level.m_nodeDeltaZ.resize( numCoarseRows * numCoarseCols );
+	for ( std::vector<CoarseConstraint>& batch : level.m_batches )
+		batch.clear();
+
+	const std::vector<int>& fineRows = level.m_fineRowOfCoarseRow;
+	const std::vector<int>& fineCols = level.m_fineColOfCoarseCol;
+	auto AddConstraint = [ & ]( CoarseBatch batch, int r1, int c1, int r2, int c2, int cellRowA, int cellColA, int cellRowB, int cellColB )
+	{
+		CoarseConstraint constraint;
+		constraint.p1 = ( fineRows[ r1 ] * m_numCols ) + fineCols[ c1 ];
+		constraint.p2 = ( fineRows[ r2 ] * m_numCols ) + fineCols[ c2 ];
+		float rowSpan = (float)( fineRows[ r2 ] - fineRows[ r1 ] );
+		float colSpan = (float)( fineCols[ c2 ] - fineCols[ c1 ] );
+		constraint.restDistance = baseDistance * sqrtf( ( rowSpan * rowSpan ) + ( colSpan * colSpan ) ); //The grid is flat at rest.
+		constraint.cellA = ( cellRowA * numCellCols ) + cellColA;
+		constraint.cellB = ( cellRowB * numCellCols ) + cellColB;
+		level.m_batches[ batch ].push_back( constraint );
+	};
+
+	for ( int r = 0; r < numCoarseRows; r++ )
+	{
+		int cellRowAbove = ( r > 0 ) ? r - 1 : r;
+		int cellRowBelow = ( r < numCoarseRows - 1 ) ? r : r - 1;
+		for ( int c = 0; c < numCoarseCols; c++ )
+		{
+			int cellColLeft = ( c > 0 ) ? c - 1 : c;
+			int cellColRight = ( c < numCoarseCols - 1 ) ? c : c - 1;
+			if ( c < numCoarseCols - 1 )
+				AddConstraint( (CoarseBatch)( HORIZONTAL_EVEN + ( c & 1 ) ), r, c, r, c + 1, cellRowAbove, c, cellRowBelow, c );
+			if ( r < numCoarseRows - 1 )
+				AddConstraint( (CoarseBatch)( VERTICAL_EVEN + ( r & 1 ) ), r, c, r + 1, c, r, cellColLeft, r, cellColRight );
+			if ( r < numCoarseRows - 1 && c < numCoarseCols - 1 )
+			{
+				AddConstraint( (CoarseBatch)( DIAGONAL_EVEN + ( r & 1 ) ), r, c, r + 1, c + 1, r, c, r, c );
+				AddConstraint( (CoarseBatch)( ANTIDIAGONAL_EVEN + ( r & 1 ) ), r, c + 1, r + 1, c, r, c, r, c );
+			}
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothHierarchy::ClearDamage()
+{
+	for ( Level& level : m_levels )
+		level.m_numDamagedInCell.assign( level.m_numDamagedInCell.size(), 0 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothHierarchy::MarkParticleDamaged( int row, int col )
+{
+	for ( Level& level : m_levels )
+	{
+		//A particle on a coarse row or column borders the cells on both sides of it.
+		int numCellRows = level.m_numCoarseRows - 1;
+		int numCellCols = level.m_numCoarseCols - 1;
+		int aboveRow = level.m_coarseRowAboveFineRow[ row ];
+		int leftCol = level.m_coarseColLeftOfFineCol[ col ];
+		for ( int cellRow = aboveRow - 1; cellRow <= aboveRow + 1; cellRow++ )
+		{
+			if ( cellRow < 0 || cellRow >= numCellRows || row < level.m_fineRowOfCoarseRow[ cellRow ] || row > level.m_fineRowOfCoarseRow[ cellRow + 1 ] )
+				continue;
+
+			for ( int cellCol = leftCol - 1; cellCol <= leftCol + 1; cellCol++ )
+			{
+				if ( cellCol < 0 || cellCol >= numCellCols || col < level.m_fineColOfCoarseCol[ cellCol ] || col > level.m_fineColOfCoarseCol[ cellCol + 1 ] )
+					continue;
+
+				++level.m_numDamagedInCell[ ( cellRow * numCellCols ) + cellCol ];
+			}
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothHierarchy::Solve( ClothParticleStore& particles, unsigned int numIterationsPerLevel, ThreadPool* threadPool )
+{
+	for ( int levelIndex = (int)m_levels.size() - 1; levelIndex >= 0; --levelIndex )
+	{
+		SolveLevel( m_levels[ levelIndex ], particles, numIterationsPerLevel, threadPool );
+		ProlongateLevel( m_levels[ levelIndex ], particles, threadPool );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothHierarchy::SolveLevel( Level& level, ClothParticleStore& particles, unsigned int numIterations, ThreadPool* threadPool )
+{
+	float* positionX = particles.m_positionX.data();
+	float* positionY = particles.m_positionY.data();
+	float* positionZ = particles.m_positionZ.data();
+	const float* inverseMass = particles.m_inverseMass.data();
+
+	unsigned int nodeIndex = 0;
+	for ( int r = 0; r < level.m_numCoarseRows; r++ )
+	{
+		for ( int c = 0; c < level.m_numCoarseCols; c++, nodeIndex++ )
+		{
+			unsigned int particleIndex = ( level.m_fineRowOfCoarseRow[ r ] * m_numCols ) + level.m_fineColOfCoarseCol[ c ];
+			level.m_nodeDeltaX[ nodeIndex ] = positionX[ particleIndex ];
+			level.m_nodeDeltaY[ nodeIndex ] = positionY[ particleIndex ];
+			level.m_nodeDeltaZ[ nodeIndex ] = positionZ[ particleIndex ];
+		}
+	}
+
+	const unsigned int* numDamagedInCell = level.m_numDamagedInCell.data();
+	for ( unsigned int iteration = 0; iteration < numIterations; ++iteration )
+	{
+		for ( const std::vector<CoarseConstraint>& batch : level.m_batches )
+		{
+			const CoarseConstraint* constraints = batch.data();
+			ThreadPool::ParallelFor( threadPool, batch.size(), CONSTRAINTS_PER_TASK, [ = ]( unsigned int begin, unsigned int end )
+			{
+				for ( unsigned int constraintIndex = begin; constraintIndex < end; constraintIndex++ )
+				{
+					const CoarseConstraint& constraint = constraints[ constraintIndex ];
+					if ( numDamagedInCell[ constraint.cellA ] != 0 || numDamagedInCell[ constraint.cellB ] != 0 )
+						continue;
+
+					unsigned int p1 = constraint.p1;
+					unsigned int p2 = constraint.p2;
+					float totalInverseMass = inverseMass[ p1 ] + inverseMass[ p2 ];
+					float dx = positionX[ p2 ] - positionX[ p1 ];
+					float dy = positionY[ p2 ] - positionY[ p1 ];
+					float dz = positionZ[ p2 ] - positionZ[ p1 ];
+					float currentDistance = sqrtf( ( dx * dx ) + ( dy * dy ) + ( dz * dz ) );
+
+					//Stretch only: the fine particles between two nodes can fold, so a coarse edge shorter than rest is not an error.
+					if ( currentDistance <= constraint.restDistance || totalInverseMass == 0.f )
+						continue;
+
+					float scale = ( currentDistance - constraint.restDistance ) / ( currentDistance * totalInverseMass );
+					positionX[ p1 ] += dx * scale * inverseMass[ p1 ];
+					positionY[ p1 ] += dy * scale * inverseMass[ p1 ];
+					positionZ[ p1 ] += dz * scale * inverseMass[ p1 ];
+					positionX[ p2 ] -= dx * scale * inverseMass[ p2 ];
+					positionY[ p2 ] -= dy * scale * inverseMass[ p2 ];
+					positionZ[ p2 ] -= dz * scale * inverseMass[ p2 ];
+				}
+			} );
+		}
+	}
+
+	nodeIndex = 0;
+	for ( int r = 0; r < level.m_numCoarseRows; r++ )
+	{
+		for ( int c = 0; c < level.m_numCoarseCols; c++, nodeIndex++ )
+		{
+			unsigned int particleIndex = ( level.m_fineRowOfCoarseRow[ r ] * m_numCols ) + level.m_fineColOfCoarseCol[ c ];
+			level.m_nodeDeltaX[ nodeIndex ] = positionX[ particleIndex ] - level.m_nodeDeltaX[ nodeIndex ];
+			level.m_nodeDeltaY[ nodeIndex ] = positionY[ particleIndex ] - level.m_nodeDeltaY[ nodeIndex ];
+			level.m_nodeDeltaZ[ nodeIndex ] = positionZ[ particleIndex ] - level.m_nodeDeltaZ[ nodeIndex ];
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothHierarchy::ProlongateLevel( const Level& level, ClothParticleStore& particles, ThreadPool* threadPool )
+{
+	ThreadPool::ParallelFor( threadPool, m_numRows, ROWS_PER_TASK, [ this, &level, &particles ]( unsigned int firstRow, unsigned int endRow )
+	{
+		int numCoarseCols = level.m_numCoarseCols;
+		int numCellCols = numCoarseCols - 1;
+		for ( int r = firstRow; r < (int)endRow; r++ )
+		{
+			int coarseRow = level.m_coarseRowAboveFineRow[ r ];
+			float rowWeight = level.m_rowWeight[ r ];
+			bool isOnCoarseRow = ( rowWeight == 0.f || rowWeight == 1.f );
+			for ( int c = 0; c < m_numCols; c++ )
+			{
+				float colWeight = level.m_colWeight[ c ];
+				if ( isOnCoarseRow && ( colWeight == 0.f || colWeight == 1.f ) )
+					continue; //Coarse nodes already moved themselves.
+
+				unsigned int particleIndex = ( r * m_numCols ) + c;
+				int coarseCol = level.m_coarseColLeftOfFineCol[ c ];
+				if ( particles.m_inverseMass[ particleIndex ] == 0.f || particles.IsExpired( particleIndex ) || level.m_numDamagedInCell[ ( coarseRow * numCellCols ) + coarseCol ] != 0 )
+					continue;
+
+				unsigned int topLeft = ( coarseRow * numCoarseCols ) + coarseCol;
+				unsigned int bottomLeft = topLeft + numCoarseCols;
+				float weightTopLeft = ( 1.f - rowWeight ) * ( 1.f - colWeight );
+				float weightTopRight = ( 1.f - rowWeight ) * colWeight;
+				float weightBottomLeft = rowWeight * ( 1.f - colWeight );
+				float weightBottomRight = rowWeight * colWeight;
+
+				particles.m_positionX[ particleIndex ] += ( weightTopLeft * level.m_nodeDeltaX[ topLeft ] ) + ( weightTopRight * level.m_nodeDeltaX[ topLeft + 1 ] )
+					+ ( weightBottomLeft * level.m_nodeDeltaX[ bottomLeft ] ) + ( weightBottomRight * level.m_nodeDeltaX[ bottomLeft + 1 ] );
+				particles.m_positionY[ particleIndex ] += ( weightTopLeft * level.m_nodeDeltaY[ topLeft ] ) + ( weightTopRight * level.m_nodeDeltaY[ topLeft + 1 ] )
+					+ ( weightBottomLeft * level.m_nodeDeltaY[ bottomLeft ] ) + ( weightBottomRight * level.m_nodeDeltaY[ bottomLeft + 1 ] );
+				particles.m_positionZ[ particleIndex ] += ( weightTopLeft * level.m_nodeDeltaZ[ topLeft ] ) + ( weightTopRight * level.m_nodeDeltaZ[ topLeft + 1 ] )
+					+ ( weightBottomLeft * level.m_nodeDeltaZ[ bottomLeft ] ) + ( weightBottomRight * level.m_nodeDeltaZ[ bottomLeft + 1 ] );
+			}
+		}
+	} );
+}
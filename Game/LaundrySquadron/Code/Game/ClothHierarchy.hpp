@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+//Coarse levels of a cloth grid for hierarchical position-based dynamics. Level k keeps every 2^k-th row and column
+//(plus the last ones, so pinned corners are always coarse nodes), linked by stretch-only distance constraints.
+//Solve runs coarsest first and spreads each level's node corrections onto every fine particle by bilinear interpolation,
+//so long-range stretch is removed in a few coarse passes instead of by waves crawling one fine constraint per pass.
+class ClothHierarchy
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothHierarchy();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void BuildForGrid( int numRows, int numCols, float baseDistance ); //Particles must be row-major, baseDistance apart at rest.
+	void Clear() { m_levels.clear(); } //Solve becomes a no-op, e.g. once the cloth has dropped all its constraints.
+	void MarkParticleDamaged( int row, int col ); //Expired or torn at: drops coarse constraints spanning the particle, so holes aren't held shut by a coarse level.
+	void ClearDamage(); //Every coarse constraint back in play, e.g. before re-marking the damage of a restored snapshot.
+	void Solve( ClothParticleStore& particles, unsigned int numIterationsPerLevel, ThreadPool* threadPool );
+	unsigned int GetNumLevels() const { return m_levels.size(); }
+
+
+private:
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int MAX_LEVELS = 6;
+	static const int MIN_NODES_PER_SIDE = 3; //A coarser level than this has no interior left to correct.
+	static const unsigned int CONSTRAINTS_PER_TASK = 1024;
+	static const int ROWS_PER_TASK = 16;
+
+	//Grid-structured coloring: horizontal edges by column parity, vertical by row parity, each diagonal direction by row parity.
+	enum CoarseBatch { HORIZONTAL_EVEN, HORIZONTAL_ODD, VERTICAL_EVEN, VERTICAL_ODD, DIAGONAL_EVEN, DIAGONAL_ODD, ANTIDIAGONAL_EVEN, ANTIDIAGONAL_ODD, NUM_COARSE_BATCHES };
+
+	struct CoarseConstraint
+	{
+		unsigned int p1; //Fine particle indices.
+		unsigned int p2;
+		float restDistance;
+		unsigned int cellA; //The coarse cells either side of the edge (equal for diagonals, and for edges on the border).
+		unsigned int cellB;
+	};
+
+	struct Level
+	{
+		int m_numCoarseRows;
+		int m_numCoarseCols;
+		std::vector<int> m_fineRowOfCoarseRow;
+		std::vector<int> m_fineColOfCoarseCol;
+		std::vector<int> m_coarseRowAboveFineRow; //Per fine row: the coarse row starting the interval it lies in, and how far along it is.
+		std::vector<float> m_rowWeight;
+		std::vector<int> m_coarseColLeftOfFineCol;
+		std::vector<float> m_colWeight;
+		std::vector<CoarseConstraint> m_batches[ NUM_COARSE_BATCHES ];
+		std::vector<unsigned int> m_numDamagedInCell; //Per coarse cell, counting its border, so any damaged particle breaks it.
+		std::vector<float> m_nodeDeltaX; //Per coarse node: position before this level's solve, then the correction it made.
+		std::vector<float> m_nodeDeltaY;
+		std::vector<float> m_nodeDeltaZ;
+	};
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void BuildLevel( Level& level, int stride, float baseDistance );
+	void SolveLevel( Level& level, ClothParticleStore& particles, unsigned int numIterations, ThreadPool* threadPool );
+	void ProlongateLevel( const Level& level, ClothParticleStore& particles, ThreadPool* threadPool );
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	int m_numRows;
+	int m_numCols;
+	std::vector<Level> m_levels; //m_levels[ 0 ] is stride 2, each after it twice as coarse.
+};
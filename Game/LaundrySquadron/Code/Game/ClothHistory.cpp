@@ -0,0 +1,48 @@
+#include "Game/ClothHistory.hpp"
+#include "Game/Cloth.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothHistory::ClothHistory( unsigned int maxNumSnapshots )
+	: m_snapshots( ( maxNumSnapshots > 0 ) ? maxNumSnapshots : 1 )
+	, m_newestSnapshot( 0 )
+	, m_numSnapshots( 0 )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothHistory::Record( const Cloth& cloth )
+{
+	m_newestSnapshot = ( m_newestSnapshot + 1 ) % m_snapshots.size();
+	if ( m_numSnapshots < m_snapshots.size() )
+		++m_numSnapshots;
+	cloth.SaveSnapshot( m_snapshots[ m_newestSnapshot ] );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ClothHistory::Rewind( Cloth& cloth, unsigned int snapshotsAgo )
+{
+	if ( snapshotsAgo >= m_numSnapshots )
+		return false;
+
+	unsigned int snapshotIndex = ( m_newestSnapshot + m_snapshots.size() - snapshotsAgo ) % m_snapshots.size();
+	if ( !cloth.RestoreSnapshot( m_snapshots[ snapshotIndex ] ) )
+		return false;
+
+	//Recording resumes from the restored snapshot, so rewinding twice keeps going back instead of toggling.
+	m_newestSnapshot = snapshotIndex;
+	m_numSnapshots -= snapshotsAgo;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ClothHistory::GetNumBytes() const
+{
+	unsigned int numBytes = 0;
+	for ( unsigned int snapshotsAgo = 0; snapshotsAgo < m_numSnapshots; ++snapshotsAgo )
+		numBytes += m_snapshots[ ( m_newestSnapshot + m_snapshots.size() - snapshotsAgo ) % m_snapshots.size() ].size();
+	return numBytes;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+class Cloth;
+
+
+//-----------------------------------------------------------------------------
+//Rolling history of one cloth's snapshots (see Cloth::SaveSnapshot), for rewinding and debugging. Once the ring is full,
+//each Record overwrites the oldest snapshot's buffer in place, so recording every frame doesn't allocate.
+class ClothHistory
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothHistory( unsigned int maxNumSnapshots );
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void Record( const Cloth& cloth );
+	bool Rewind( Cloth& cloth, unsigned int snapshotsAgo ); //0 == the newest. Snapshots newer than the one restored are dropped.
+	void Clear() { m_numSnapshots = 0; } //Buffers are kept for reuse.
+	unsigned int GetNumSnapshots() const { return m_numSnapshots; }
+	unsigned int GetMaxNumSnapshots() const { return m_snapshots.size(); }
+	unsigned int GetNumBytes() const; //Of the snapshots currently held.
+
+
+private:
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	std::vector<std::vector<unsigned char>> m_snapshots; //Ring buffer, newest at m_newestSnapshot.
+	unsigned int m_newestSnapshot;
+	unsigned int m_numSnapshots;
+};
@@ -0,0 +1,340 @@
+#include "Game/ClothImplicitSolver.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include <cmath>
+
+
+//--------------------------------------------------------------------------------------------------------------
+const float ClothImplicitSolver::DEFAULT_STRETCH_STIFFNESS = 5000.f; //A 10-row sheet of 1 kg particles hangs about 2% longer at the top.
+const float ClothImplicitSolver::DEFAULT_SHEAR_STIFFNESS = 500.f;
+const float ClothImplicitSolver::DEFAULT_BEND_STIFFNESS = 50.f; //Soft enough to drape and fold.
+const float ClothImplicitSolver::DEFAULT_DAMPING = 5.f;
+const float ClothImplicitSolver::DEFAULT_TOLERANCE = 1e-3f;
+static const float MIN_SPRING_LENGTH = 1e-6f; //A collapsed spring has no direction to push along; it sits out the step.
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothImplicitSolver::ClothImplicitSolver()
+	: m_damping( DEFAULT_DAMPING )
+	, m_maxIterations( DEFAULT_MAX_ITERATIONS )
+	, m_tolerance( DEFAULT_TOLERANCE )
+	, m_numIterationsLastStep( 0 )
+	, m_relativeResidualLastStep( 0.0 )
+{
+	m_stiffness[ STRETCH ] = DEFAULT_STRETCH_STIFFNESS;
+	m_stiffness[ SHEAR ] = DEFAULT_SHEAR_STIFFNESS;
+	m_stiffness[ BEND ] = DEFAULT_BEND_STIFFNESS;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+double ClothImplicitSolver::Step( ClothParticleStore& particles, const std::vector<ClothConstraintBatch>& batches, float deltaSeconds, ThreadPool* threadPool )
+{
+	const unsigned int numParticles = particles.GetNumParticles();
+	m_mass.resize( numParticles );
+	m_inverseDiagonal.Resize( numParticles );
+	m_deltaVelocity.Resize( numParticles );
+	m_residual.Resize( numParticles );
+	m_preconditioned.Resize( numParticles );
+	m_direction.Resize( numParticles );
+	m_product.Resize( numParticles );
+
+	double squaredStretch = BuildSystem( particles, batches, deltaSeconds, threadPool );
+
+	//Preconditioned conjugate gradient from dv = 0, so the first residual is the right-hand side.
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			m_deltaVelocity.x[ index ] = 0.f;
+			m_deltaVelocity.y[ index ] = 0.f;
+			m_deltaVelocity.z[ index ] = 0.f;
+			m_preconditioned.x[ index ] = m_residual.x[ index ] * m_inverseDiagonal.x[ index ];
+			m_preconditioned.y[ index ] = m_residual.y[ index ] * m_inverseDiagonal.y[ index ];
+			m_preconditioned.z[ index ] = m_residual.z[ index ] * m_inverseDiagonal.z[ index ];
+			m_direction.x[ index ] = m_preconditioned.x[ index ];
+			m_direction.y[ index ] = m_preconditioned.y[ index ];
+			m_direction.z[ index ] = m_preconditioned.z[ index ];
+		}
+	} );
+
+	double rightHandSideNorm = Dot( m_residual, m_residual, threadPool );
+	double residualNorm = rightHandSideNorm;
+	double residualDotPreconditioned = Dot( m_residual, m_preconditioned, threadPool );
+	double maxConvergedNorm = static_cast<double>( m_tolerance ) * m_tolerance * rightHandSideNorm;
+	unsigned int numIterations = 0;
+	while ( numIterations < m_maxIterations && residualNorm > maxConvergedNorm )
+	{
+		MultiplySystem( m_direction, m_product, batches, threadPool );
+		double curvature = Dot( m_direction, m_product, threadPool );
+		if ( curvature <= 0.0 ) //Only reachable through round-off once the residual is ~0: the system is positive definite.
+			break;
+
+		float stepLength = static_cast<float>( residualDotPreconditioned / curvature );
+		ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, stepLength ]( unsigned int begin, unsigned int end )
+		{
+			for ( unsigned int index = begin; index < end; index++ )
+			{
+				m_deltaVelocity.x[ index ] += stepLength * m_direction.x[ index ];
+				m_deltaVelocity.y[ index ] += stepLength * m_direction.y[ index ];
+				m_deltaVelocity.z[ index ] += stepLength * m_direction.z[ index ];
+				m_residual.x[ index ] -= stepLength * m_product.x[ index ];
+				m_residual.y[ index ] -= stepLength * m_product.y[ index ];
+				m_residual.z[ index ] -= stepLength * m_product.z[ index ];
+				m_preconditioned.x[ index ] = m_residual.x[ index ] * m_inverseDiagonal.x[ index ];
+				m_preconditioned.y[ index ] = m_residual.y[ index ] * m_inverseDiagonal.y[ index ];
+				m_preconditioned.z[ index ] = m_residual.z[ index ] * m_inverseDiagonal.z[ index ];
+			}
+		} );
+		++numIterations;
+
+		residualNorm = Dot( m_residual, m_residual, threadPool );
+		double newResidualDotPreconditioned = Dot( m_residual, m_preconditioned, threadPool );
+		float conjugation = static_cast<float>( newResidualDotPreconditioned / residualDotPreconditioned );
+		residualDotPreconditioned = newResidualDotPreconditioned;
+		ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, conjugation ]( unsigned int begin, unsigned int end )
+		{
+			for ( unsigned int index = begin; index < end; index++ )
+			{
+				m_direction.x[ index ] = m_preconditioned.x[ index ] + ( conjugation * m_direction.x[ index ] );
+				m_direction.y[ index ] = m_preconditioned.y[ index ] + ( conjugation * m_direction.y[ index ] );
+				m_direction.z[ index ] = m_preconditioned.z[ index ] + ( conjugation * m_direction.z[ index ] );
+			}
+		} );
+	}
+	m_numIterationsLastStep = numIterations;
+	m_relativeResidualLastStep = ( rightHandSideNorm > 0.0 ) ? sqrt( residualNorm / rightHandSideNorm ) : 0.0;
+
+	//v' := v + dv, x_prev := x, x' := x + v'*h. Held particles keep their velocity, as Verlet would carry them.
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, &particles, deltaSeconds ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			particles.m_velocityX[ index ] += m_deltaVelocity.x[ index ];
+			particles.m_velocityY[ index ] += m_deltaVelocity.y[ index ];
+			particles.m_velocityZ[ index ] += m_deltaVelocity.z[ index ];
+			particles.m_previousPositionX[ index ] = particles.m_positionX[ index ];
+			particles.m_previousPositionY[ index ] = particles.m_positionY[ index ];
+			particles.m_previousPositionZ[ index ] = particles.m_positionZ[ index ];
+			particles.m_positionX[ index ] += particles.m_velocityX[ index ] * deltaSeconds;
+			particles.m_positionY[ index ] += particles.m_velocityY[ index ] * deltaSeconds;
+			particles.m_positionZ[ index ] += particles.m_velocityZ[ index ] * deltaSeconds;
+		}
+	} );
+	return squaredStretch;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+double ClothImplicitSolver::BuildSystem( const ClothParticleStore& particles, const std::vector<ClothConstraintBatch>& batches, float deltaSeconds, ThreadPool* threadPool )
+{
+	//Right-hand side into m_residual and the diagonal into m_inverseDiagonal (inverted at the end), starting from the mass terms.
+	const unsigned int numParticles = particles.GetNumParticles();
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, &particles, deltaSeconds ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			float inverseMass = particles.m_inverseMass[ index ];
+			float mass = ( inverseMass > 0.f ) ? ( 1.f / inverseMass ) : 0.f;
+			m_mass[ index ] = mass;
+			m_inverseDiagonal.x[ index ] = mass;
+			m_inverseDiagonal.y[ index ] = mass;
+			m_inverseDiagonal.z[ index ] = mass;
+			m_residual.x[ index ] = particles.m_accelerationX[ index ] * deltaSeconds;
+			m_residual.y[ index ] = particles.m_accelerationY[ index ] * deltaSeconds;
+			m_residual.z[ index ] = particles.m_accelerationZ[ index ] * deltaSeconds;
+		}
+	} );
+
+	m_batchOffsets.resize( batches.size() );
+	unsigned int numConstraints = 0;
+	for ( unsigned int batchIndex = 0; batchIndex < batches.size(); ++batchIndex )
+	{
+		m_batchOffsets[ batchIndex ] = numConstraints;
+		numConstraints += batches[ batchIndex ].m_constraints.size();
+	}
+	m_directionX.resize( numConstraints );
+	m_directionY.resize( numConstraints );
+	m_directionZ.resize( numConstraints );
+	m_isotropic.resize( numConstraints );
+	m_alongDirection.resize( numConstraints );
+
+	//Per spring, with d = x1 - x2 and c = max( 0, 1 - rest / |d| ) so a compressed spring's block stays positive semi-definite:
+	//	force on p1 = -k * ( |d| - rest ) * dir - damping * ( dir . v12 ) * dir, and K * v12 = k * ( c * v12 + ( 1 - c ) * ( dir . v12 ) * dir ).
+	double squaredStretch = 0.0;
+	for ( unsigned int batchIndex = 0; batchIndex < batches.size(); ++batchIndex )
+	{
+		const ClothConstraintBatch& batch = batches[ batchIndex ];
+		const unsigned int offset = m_batchOffsets[ batchIndex ];
+		const float stiffness = m_stiffness[ batch.m_type ];
+		const unsigned int numBatchConstraints = batch.m_constraints.size();
+		m_chunkSums.assign( ( numBatchConstraints + CONSTRAINTS_PER_TASK - 1 ) / CONSTRAINTS_PER_TASK, 0.0 );
+		ThreadPool::ParallelFor( threadPool, numBatchConstraints, CONSTRAINTS_PER_TASK, [ this, &particles, &batch, offset, stiffness, deltaSeconds ]( unsigned int begin, unsigned int end )
+		{
+			double chunkStretch = 0.0;
+			for ( unsigned int slot = begin; slot < end; slot++ )
+			{
+				const ClothConstraint& cc = batch.m_constraints[ slot ];
+				const unsigned int edgeIndex = offset + slot;
+				float dx = particles.m_positionX[ cc.p1 ] - particles.m_positionX[ cc.p2 ];
+				float dy = particles.m_positionY[ cc.p1 ] - particles.m_positionY[ cc.p2 ];
+				float dz = particles.m_positionZ[ cc.p1 ] - particles.m_positionZ[ cc.p2 ];
+				float length = sqrtf( ( dx * dx ) + ( dy * dy ) + ( dz * dz ) );
+				float stretch = length - cc.restDistance;
+				chunkStretch += stretch * stretch;
+				if ( length < MIN_SPRING_LENGTH )
+				{
+					m_directionX[ edgeIndex ] = m_directionY[ edgeIndex ] = m_directionZ[ edgeIndex ] = 0.f;
+					m_isotropic[ edgeIndex ] = m_alongDirection[ edgeIndex ] = 0.f;
+					continue;
+				}
+
+				float inverseLength = 1.f / length;
+				float dirX = dx * inverseLength;
+				float dirY = dy * inverseLength;
+				float dirZ = dz * inverseLength;
+				float transverse = 1.f - ( cc.restDistance * inverseLength );
+				if ( transverse < 0.f )
+					transverse = 0.f;
+
+				float relativeVelocityX = particles.m_velocityX[ cc.p1 ] - particles.m_velocityX[ cc.p2 ];
+				float relativeVelocityY = particles.m_velocityY[ cc.p1 ] - particles.m_velocityY[ cc.p2 ];
+				float relativeVelocityZ = particles.m_velocityZ[ cc.p1 ] - particles.m_velocityZ[ cc.p2 ];
+				float stretchRate = ( dirX * relativeVelocityX ) + ( dirY * relativeVelocityY ) + ( dirZ * relativeVelocityZ );
+
+				//h * ( f - h * K * v ) for p1, with the sign folded in; p2 gets the negation.
+				float alongDirectionForce = ( -stiffness * stretch ) - ( m_damping * stretchRate ) - ( deltaSeconds * stiffness * ( 1.f - transverse ) * stretchRate );
+				float isotropicForce = -deltaSeconds * stiffness * transverse;
+				float impulseX = deltaSeconds * ( ( alongDirectionForce * dirX ) + ( isotropicForce * relativeVelocityX ) );
+				float impulseY = deltaSeconds * ( ( alongDirectionForce * dirY ) + ( isotropicForce * relativeVelocityY ) );
+				float impulseZ = deltaSeconds * ( ( alongDirectionForce * dirZ ) + ( isotropicForce * relativeVelocityZ ) );
+				m_residual.x[ cc.p1 ] += impulseX;
+				m_residual.y[ cc.p1 ] += impulseY;
+				m_residual.z[ cc.p1 ] += impulseZ;
+				m_residual.x[ cc.p2 ] -= impulseX;
+				m_residual.y[ cc.p2 ] -= impulseY;
+				m_residual.z[ cc.p2 ] -= impulseZ;
+
+				//This spring's block of h*D + h^2*K.
+				float isotropic = deltaSeconds * deltaSeconds * stiffness * transverse;
+				float alongDirection = ( deltaSeconds * deltaSeconds * stiffness * ( 1.f - transverse ) ) + ( deltaSeconds * m_damping );
+				m_directionX[ edgeIndex ] = dirX;
+				m_directionY[ edgeIndex ] = dirY;
+				m_directionZ[ edgeIndex ] = dirZ;
+				m_isotropic[ edgeIndex ] = isotropic;
+				m_alongDirection[ edgeIndex ] = alongDirection;
+
+				float diagonalX = isotropic + ( alongDirection * dirX * dirX );
+				float diagonalY = isotropic + ( alongDirection * dirY * dirY );
+				float diagonalZ = isotropic + ( alongDirection * dirZ * dirZ );
+				m_inverseDiagonal.x[ cc.p1 ] += diagonalX;
+				m_inverseDiagonal.y[ cc.p1 ] += diagonalY;
+				m_inverseDiagonal.z[ cc.p1 ] += diagonalZ;
+				m_inverseDiagonal.x[ cc.p2 ] += diagonalX;
+				m_inverseDiagonal.y[ cc.p2 ] += diagonalY;
+				m_inverseDiagonal.z[ cc.p2 ] += diagonalZ;
+			}
+			m_chunkSums[ begin / CONSTRAINTS_PER_TASK ] = chunkStretch;
+		} );
+
+		for ( double chunkStretch : m_chunkSums )
+			squaredStretch += chunkStretch;
+	}
+
+	//Held particles drop out: a zero preconditioner keeps them out of every search direction, so their dv stays 0.
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			bool isHeld = ( m_mass[ index ] == 0.f );
+			m_inverseDiagonal.x[ index ] = isHeld ? 0.f : ( 1.f / m_inverseDiagonal.x[ index ] );
+			m_inverseDiagonal.y[ index ] = isHeld ? 0.f : ( 1.f / m_inverseDiagonal.y[ index ] );
+			m_inverseDiagonal.z[ index ] = isHeld ? 0.f : ( 1.f / m_inverseDiagonal.z[ index ] );
+			if ( isHeld )
+			{
+				m_residual.x[ index ] = 0.f;
+				m_residual.y[ index ] = 0.f;
+				m_residual.z[ index ] = 0.f;
+			}
+		}
+	} );
+	return squaredStretch;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothImplicitSolver::MultiplySystem( const VectorArrays& input, VectorArrays& out_product, const std::vector<ClothConstraintBatch>& batches, ThreadPool* threadPool ) const
+{
+	const unsigned int numParticles = m_mass.size();
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, &input, &out_product ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			out_product.x[ index ] = m_mass[ index ] * input.x[ index ];
+			out_product.y[ index ] = m_mass[ index ] * input.y[ index ];
+			out_product.z[ index ] = m_mass[ index ] * input.z[ index ];
+		}
+	} );
+
+	for ( unsigned int batchIndex = 0; batchIndex < batches.size(); ++batchIndex )
+	{
+		const ClothConstraintBatch& batch = batches[ batchIndex ];
+		const unsigned int offset = m_batchOffsets[ batchIndex ];
+		ThreadPool::ParallelFor( threadPool, batch.m_constraints.size(), CONSTRAINTS_PER_TASK, [ this, &batch, offset, &input, &out_product ]( unsigned int begin, unsigned int end )
+		{
+			for ( unsigned int slot = begin; slot < end; slot++ )
+			{
+				const ClothConstraint& cc = batch.m_constraints[ slot ];
+				const unsigned int edgeIndex = offset + slot;
+				float differenceX = input.x[ cc.p1 ] - input.x[ cc.p2 ];
+				float differenceY = input.y[ cc.p1 ] - input.y[ cc.p2 ];
+				float differenceZ = input.z[ cc.p1 ] - input.z[ cc.p2 ];
+				float alongDirection = m_alongDirection[ edgeIndex ] * ( ( m_directionX[ edgeIndex ] * differenceX ) + ( m_directionY[ edgeIndex ] * differenceY ) + ( m_directionZ[ edgeIndex ] * differenceZ ) );
+				float isotropic = m_isotropic[ edgeIndex ];
+				float productX = ( isotropic * differenceX ) + ( alongDirection * m_directionX[ edgeIndex ] );
+				float productY = ( isotropic * differenceY ) + ( alongDirection * m_directionY[ edgeIndex ] );
+				float productZ = ( isotropic * differenceZ ) + ( alongDirection * m_directionZ[ edgeIndex ] );
+				out_product.x[ cc.p1 ] += productX;
+				out_product.y[ cc.p1 ] += productY;
+				out_product.z[ cc.p1 ] += productZ;
+				out_product.x[ cc.p2 ] -= productX;
+				out_product.y[ cc.p2 ] -= productY;
+				out_product.z[ cc.p2 ] -= productZ;
+			}
+		} );
+	}
+
+	//Held rows are identity rows with a zero right-hand side; filtering them to 0 keeps them out of the search.
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, &out_product ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			if ( m_mass[ index ] == 0.f )
+			{
+				out_product.x[ index ] = 0.f;
+				out_product.y[ index ] = 0.f;
+				out_product.z[ index ] = 0.f;
+			}
+		}
+	} );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+double ClothImplicitSolver::Dot( const VectorArrays& lhs, const VectorArrays& rhs, ThreadPool* threadPool )
+{
+	const unsigned int numParticles = m_mass.size();
+	m_chunkSums.assign( ( numParticles + PARTICLES_PER_TASK - 1 ) / PARTICLES_PER_TASK, 0.0 );
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, &lhs, &rhs ]( unsigned int begin, unsigned int end )
+	{
+		double sum = 0.0;
+		for ( unsigned int index = begin; index < end; index++ )
+			sum += ( lhs.x[ index ] * rhs.x[ index ] ) + ( lhs.y[ index ] * rhs.y[ index ] ) + ( lhs.z[ index ] * rhs.z[ index ] );
+		m_chunkSums[ begin / PARTICLES_PER_TASK ] = sum;
+	} );
+
+	double total = 0.0;
+	for ( double sum : m_chunkSums )
+		total += sum;
+	return total;
+}
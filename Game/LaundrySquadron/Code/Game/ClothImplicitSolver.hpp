@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include "Game/ClothConstraints.hpp"
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+//Backward Euler for a cloth whose constraints are treated as damped springs instead of being projected.
+//Each step linearizes the spring forces about the step's start and solves
+//	( M + h*D + h^2*K ) dv = h * ( f - h*K*v ), with K = -df/dx and D = -df/dv of the springs,
+//for the change in velocity, by conjugate gradient preconditioned with the diagonal. K and D are never assembled: every product
+//runs over the constraint batches, whose constraints share no particles, so each batch scatters in parallel without locks.
+//Particles with zero inverse mass (pinned or asleep) keep their velocity. Stable for any step size, so one 1/60 s step can
+//replace several explicit ones; the trade is that springs stretch under load where PBD's constraints stay rigid.
+class ClothImplicitSolver
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothImplicitSolver();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	//Advances positions and velocities by deltaSeconds, leaving x_prev at the step's start. Reads each particle's external force
+	//(not yet divided by mass) from particles.m_acceleration. Returns the summed squared stretch of the springs going into the step.
+	double Step( ClothParticleStore& particles, const std::vector<ClothConstraintBatch>& batches, float deltaSeconds, ThreadPool* threadPool );
+	void SetStiffness( ConstraintType constraintType, float stiffness ) { m_stiffness[ constraintType ] = stiffness; } //N/m.
+	float GetStiffness( ConstraintType constraintType ) const { return m_stiffness[ constraintType ]; }
+	void SetDamping( float damping ) { m_damping = damping; } //N*s/m along each spring, against the rate it stretches.
+	float GetDamping() const { return m_damping; }
+	void SetMaxIterations( unsigned int maxIterations ) { m_maxIterations = ( maxIterations > 0 ) ? maxIterations : 1; }
+	unsigned int GetMaxIterations() const { return m_maxIterations; }
+	void SetTolerance( float tolerance ) { m_tolerance = tolerance; } //On the residual relative to the right-hand side.
+	float GetTolerance() const { return m_tolerance; }
+	unsigned int GetNumIterationsLastStep() const { return m_numIterationsLastStep; }
+	double GetRelativeResidualLastStep() const { return m_relativeResidualLastStep; }
+
+
+private:
+	struct VectorArrays //One float array per axis, like the particle store.
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		void Resize( unsigned int numParticles ) { x.resize( numParticles ); y.resize( numParticles ); z.resize( numParticles ); }
+	};
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int PARTICLES_PER_TASK = 1024;
+	static const unsigned int CONSTRAINTS_PER_TASK = 1024;
+	static const unsigned int DEFAULT_MAX_ITERATIONS = 50;
+	static const float DEFAULT_STRETCH_STIFFNESS;
+	static const float DEFAULT_SHEAR_STIFFNESS;
+	static const float DEFAULT_BEND_STIFFNESS;
+	static const float DEFAULT_DAMPING;
+	static const float DEFAULT_TOLERANCE;
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	double BuildSystem( const ClothParticleStore& particles, const std::vector<ClothConstraintBatch>& batches, float deltaSeconds, ThreadPool* threadPool ); //Returns squared stretch.
+	void MultiplySystem( const VectorArrays& input, VectorArrays& out_product, const std::vector<ClothConstraintBatch>& batches, ThreadPool* threadPool ) const;
+	double Dot( const VectorArrays& lhs, const VectorArrays& rhs, ThreadPool* threadPool );
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	float m_stiffness[ NUM_CONSTRAINT_TYPES ];
+	float m_damping;
+	unsigned int m_maxIterations;
+	float m_tolerance;
+	unsigned int m_numIterationsLastStep;
+	double m_relativeResidualLastStep;
+
+	//Per constraint, in batch order (batch b's constraints start at m_batchOffsets[ b ]): the spring's direction and the two
+	//coefficients of its block of h*D + h^2*K, which is isotropic * I + alongDirection * ( direction * direction^T ).
+	std::vector<unsigned int> m_batchOffsets;
+	std::vector<float> m_directionX;
+	std::vector<float> m_directionY;
+	std::vector<float> m_directionZ;
+	std::vector<float> m_isotropic;
+	std::vector<float> m_alongDirection;
+	std::vector<double> m_chunkSums; //Per task, summed in order so results don't depend on scheduling.
+
+	//Per particle.
+	std::vector<float> m_mass; //0 marks a particle whose velocity is held: its rows of the system are skipped.
+	VectorArrays m_inverseDiagonal; //The preconditioner. 0 for held particles, which also filters them out of every search direction.
+	VectorArrays m_deltaVelocity;
+	VectorArrays m_residual;
+	VectorArrays m_preconditioned;
+	VectorArrays m_direction;
+	VectorArrays m_product;
+};
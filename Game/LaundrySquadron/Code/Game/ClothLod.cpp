@@ -0,0 +1,156 @@
+#include "Game/ClothLod.hpp"
+#include "Game/Cloth.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cmath>
+
+
+//--------------------------------------------------------------------------------------------------------------
+const float ClothLod::DEFAULT_MAX_CELL_PIXELS = 8.f; //Past about 8 pixels a cell, the facets of a coarser level start to show.
+const float ClothLod::DEFAULT_HYSTERESIS = .25f;
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothLod::ClothLod( const Vector3& originTopLeftPosition,
+					ParticleType particleRenderType, float particleMass, float particleRadius,
+					int numRows, int numCols,
+					unsigned int numConstraintSolverIterations,
+					double baseDistanceBetweenParticles,
+					double ratioDistanceStructuralToShear,
+					double ratioDistanceStructuralToBend,
+					unsigned int numLevels /*= MAX_NUM_LEVELS*/ )
+	: m_activeLevel( 0 )
+	, m_maxCellPixels( DEFAULT_MAX_CELL_PIXELS )
+	, m_hysteresis( DEFAULT_HYSTERESIS )
+{
+	if ( numLevels > MAX_NUM_LEVELS )
+		numLevels = MAX_NUM_LEVELS;
+
+	int levelRows = numRows;
+	int levelCols = numCols;
+	for ( unsigned int levelIndex = 0; levelIndex < numLevels; ++levelIndex )
+	{
+		if ( levelIndex > 0 )
+		{
+			levelRows = ( levelRows + 1 ) / 2;
+			levelCols = ( levelCols + 1 ) / 2;
+			if ( levelRows < 2 || levelCols < 2 )
+				break; //No sheet left to halve.
+		}
+
+		//Same extent and total mass as level 0: fewer, farther apart, heavier particles.
+		double levelBaseDistance = baseDistanceBetweenParticles * static_cast<double>( numCols - 1 ) / static_cast<double>( levelCols - 1 );
+		float levelParticleMass = particleMass * static_cast<float>( numRows * numCols ) / static_cast<float>( levelRows * levelCols );
+		m_levels.push_back( new Cloth( originTopLeftPosition, particleRenderType, levelParticleMass, particleRadius, levelRows, levelCols,
+									   numConstraintSolverIterations, levelBaseDistance, ratioDistanceStructuralToShear, ratioDistanceStructuralToBend ) );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothLod::~ClothLod()
+{
+	for ( Cloth* level : m_levels )
+		delete level;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+float ClothLod::CalcCellPixels( unsigned int levelIndex, float distance, float pixelsPerUnitAtUnitDistance ) const
+{
+	return static_cast<float>( m_levels[ levelIndex ]->GetBaseDistanceBetweenParticles() ) * pixelsPerUnitAtUnitDistance / distance;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ClothLod::UpdateLevel( const Vector3& viewPosition, float pixelsPerUnitAtUnitDistance )
+{
+	const Cloth& activeCloth = *GetActiveCloth();
+	Vector3 topLeftPosition = activeCloth.GetParticlePosition( activeCloth.GetParticleIndex( 0, 0 ) );
+	Vector3 bottomRightPosition = activeCloth.GetParticlePosition( activeCloth.GetParticleIndex( activeCloth.GetNumRows() - 1, activeCloth.GetNumCols() - 1 ) );
+	Vector3 toCenter = ( ( topLeftPosition + bottomRightPosition ) * .5f ) - viewPosition;
+	float distance = sqrtf( MathUtils::Dot( toCenter, toCenter ) );
+	if ( distance < 1e-3f )
+		distance = 1e-3f;
+
+	//Finer as soon as the active level's cells grow past the budget, coarser only once the coarser level's cells fit well within it:
+	//the band between the two keeps a camera at the boundary from switching back and forth.
+	const float finerPixels = m_maxCellPixels * ( 1.f + m_hysteresis );
+	const float coarserPixels = m_maxCellPixels * ( 1.f - m_hysteresis );
+	unsigned int desiredLevel = m_activeLevel;
+	while ( desiredLevel > 0 && CalcCellPixels( desiredLevel, distance, pixelsPerUnitAtUnitDistance ) > finerPixels )
+		--desiredLevel;
+	if ( desiredLevel == m_activeLevel )
+	{
+		while ( desiredLevel + 1 < m_levels.size() && CalcCellPixels( desiredLevel + 1, distance, pixelsPerUnitAtUnitDistance ) < coarserPixels )
+			++desiredLevel;
+	}
+
+	if ( desiredLevel == m_activeLevel || IsDamaged( activeCloth ) )
+		return false;
+
+	SetActiveLevel( desiredLevel );
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothLod::SetActiveLevel( unsigned int levelIndex )
+{
+	if ( levelIndex >= m_levels.size() || levelIndex == m_activeLevel )
+		return;
+
+	TransferState( *m_levels[ m_activeLevel ], *m_levels[ levelIndex ] );
+	m_activeLevel = levelIndex;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ClothLod::IsDamaged( const Cloth& cloth ) const
+{
+	return cloth.GetNumTornConstraints() > 0 || cloth.GetNumExpiredParticles() > 0; //Both kept as counts, so this stays O(1) per cloth.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothLod::TransferState( const Cloth& source, Cloth& destination ) const
+{
+	//Every level spans the same sheet, so a particle's place in its grid, as a fraction of the grid, names the same spot of cloth
+	//on every level. Sample the source there bilinearly. Corners land exactly on corners, so the pins carry over unchanged.
+	const int sourceRows = source.GetNumRows();
+	const int sourceCols = source.GetNumCols();
+	const float rowScale = static_cast<float>( sourceRows - 1 ) / static_cast<float>( destination.GetNumRows() - 1 );
+	const float colScale = static_cast<float>( sourceCols - 1 ) / static_cast<float>( destination.GetNumCols() - 1 );
+	for ( int r = 0; r < destination.GetNumRows(); r++ )
+	{
+		float sourceRow = r * rowScale;
+		int row0 = static_cast<int>( sourceRow );
+		if ( row0 > sourceRows - 2 )
+			row0 = sourceRows - 2;
+		float rowFraction = sourceRow - static_cast<float>( row0 );
+
+		for ( int c = 0; c < destination.GetNumCols(); c++ )
+		{
+			float sourceCol = c * colScale;
+			int col0 = static_cast<int>( sourceCol );
+			if ( col0 > sourceCols - 2 )
+				col0 = sourceCols - 2;
+			float colFraction = sourceCol - static_cast<float>( col0 );
+
+			unsigned int topLeft = source.GetParticleIndex( row0, col0 );
+			unsigned int topRight = source.GetParticleIndex( row0, col0 + 1 );
+			unsigned int bottomLeft = source.GetParticleIndex( row0 + 1, col0 );
+			unsigned int bottomRight = source.GetParticleIndex( row0 + 1, col0 + 1 );
+			float weightTopLeft = ( 1.f - rowFraction ) * ( 1.f - colFraction );
+			float weightTopRight = ( 1.f - rowFraction ) * colFraction;
+			float weightBottomLeft = rowFraction * ( 1.f - colFraction );
+			float weightBottomRight = rowFraction * colFraction;
+
+			Vector3 position = ( source.GetParticlePosition( topLeft ) * weightTopLeft ) + ( source.GetParticlePosition( topRight ) * weightTopRight )
+				+ ( source.GetParticlePosition( bottomLeft ) * weightBottomLeft ) + ( source.GetParticlePosition( bottomRight ) * weightBottomRight );
+			Vector3 velocity = ( source.GetParticleVelocity( topLeft ) * weightTopLeft ) + ( source.GetParticleVelocity( topRight ) * weightTopRight )
+				+ ( source.GetParticleVelocity( bottomLeft ) * weightBottomLeft ) + ( source.GetParticleVelocity( bottomRight ) * weightBottomRight );
+			destination.PlaceParticle( destination.GetParticleIndex( r, c ), position, velocity );
+		}
+	}
+	destination.SetTopLeftPosition( source.GetCurrentTopLeftPosition() );
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include "Engine/Math/Vector3.hpp"
+#include "Game/Physics.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Cloth;
+
+
+//-----------------------------------------------------------------------------
+//One sheet built at up to MAX_NUM_LEVELS resolutions, of which only the active one is simulated and drawn. Each level halves
+//the particles along both sides (10x10, 5x5, 3x3), so a level costs about a quarter of the one above it, while keeping the
+//sheet's size, pins and total mass. The level follows how big a cell would look on screen: UpdateLevel picks the coarsest
+//level whose cells stay under the pixel budget, and only crosses a threshold once it's past it by the hysteresis, so a camera
+//sitting on the boundary doesn't flicker between levels. On a switch the new level takes the old one's shape and motion.
+class ClothLod
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	//Level 0 is exactly the Cloth these arguments would build. numLevels is clamped to what the grid can be halved into.
+	ClothLod( const Vector3& originTopLeftPosition,
+			  ParticleType particleRenderType, float particleMass, float particleRadius,
+			  int numRows, int numCols,
+			  unsigned int numConstraintSolverIterations,
+			  double baseDistanceBetweenParticles,
+			  double ratioDistanceStructuralToShear,
+			  double ratioDistanceStructuralToBend,
+			  unsigned int numLevels = MAX_NUM_LEVELS );
+	~ClothLod();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	//Returns whether the active level changed. pixelsPerUnitAtUnitDistance is the projection's scale: viewport height / ( 2 tan( fovY / 2 ) ).
+	bool UpdateLevel( const Vector3& viewPosition, float pixelsPerUnitAtUnitDistance );
+	void SetActiveLevel( unsigned int levelIndex ); //Transfers the current shape and motion onto levelIndex.
+	unsigned int GetActiveLevel() const { return m_activeLevel; }
+	Cloth* GetActiveCloth() const { return m_levels[ m_activeLevel ]; }
+	unsigned int GetNumLevels() const { return m_levels.size(); }
+	Cloth* GetLevel( unsigned int levelIndex ) const { return m_levels[ levelIndex ]; } //Settings (forces, solver, wind) are per level: set them on each.
+	void SetMaxCellPixels( float maxCellPixels ) { m_maxCellPixels = maxCellPixels; } //Coarsest level whose cells project to at most this many pixels tall.
+	float GetMaxCellPixels() const { return m_maxCellPixels; }
+	void SetHysteresis( float hysteresis ) { m_hysteresis = hysteresis; } //Fraction past the pixel budget a level must be before switching.
+	float GetHysteresis() const { return m_hysteresis; }
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int MAX_NUM_LEVELS = 3;
+
+
+private:
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	float CalcCellPixels( unsigned int levelIndex, float distance, float pixelsPerUnitAtUnitDistance ) const;
+	bool IsDamaged( const Cloth& cloth ) const; //Holes and tears don't survive resampling, so a damaged cloth keeps its level.
+	void TransferState( const Cloth& source, Cloth& destination ) const;
+
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const float DEFAULT_MAX_CELL_PIXELS;
+	static const float DEFAULT_HYSTERESIS;
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	std::vector<Cloth*> m_levels; //Owned. Finest first.
+	unsigned int m_activeLevel;
+	float m_maxCellPixels;
+	float m_hysteresis;
+};
@@ -0,0 +1,305 @@
+#include "Game/ClothMesh.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Engine/Renderer/TheRenderer.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include <cmath>
+
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+	#define CLOTH_MESH_SSE
+	#include <emmintrin.h>
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const float AMBIENT_LIGHT = .35f;
+static const float MIN_LENGTH_SQUARED = 1e-20f; //Keeps degenerate (fully collapsed) frames finite; they normalize to ~0 instead of NaN.
+static const Vector3 LIGHT_DIRECTION = Vector3::GetNormalized( Vector3( -1.f, -2.f, 3.f ) ); //Fixed key light, until cloth renders through a Material.
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothMesh::ClothMesh()
+	: m_numRows( 0 )
+	, m_numCols( 0 )
+	, m_vboID( 0 )
+	, m_iboID( 0 )
+	, m_isIndexBufferDirty( true )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothMesh::~ClothMesh()
+{
+	if ( TheRenderer::instance == nullptr )
+		return;
+
+	if ( m_vboID != 0 )
+		TheRenderer::instance->DeleteBuffers( m_vboID );
+	if ( m_iboID != 0 )
+		TheRenderer::instance->DeleteBuffers( m_iboID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::BuildForGrid( int numRows, int numCols )
+{
+	m_numRows = numRows;
+	m_numCols = numCols;
+
+	//Same UVs the old per-quad path computed: U runs 1 -> 0 left to right, V runs 0 -> 1 top to bottom.
+	unsigned int numVertexes = numRows * numCols;
+	m_vertexes.resize( numVertexes );
+	std::vector<float>* soaArrays[] = { &m_positionX, &m_positionY, &m_positionZ, &m_tangentX, &m_tangentY, &m_tangentZ,
+										&m_bitangentX, &m_bitangentY, &m_bitangentZ, &m_normalX, &m_normalY, &m_normalZ };
+	for ( std::vector<float>* soaArray : soaArrays )
+		soaArray->assign( numVertexes, 0.f );
+
+	for ( int r = 0; r < numRows; r++ )
+	{
+		for ( int c = 0; c < numCols; c++ )
+		{
+			Vertex_PCT& vertex = m_vertexes[ ( r * numCols ) + c ];
+			vertex.color = RGBA::WHITE;
+			vertex.texCoords = Vector2( 1.f - ( (float)c / (float)( numCols - 1 ) ), (float)r / (float)( numRows - 1 ) );
+		}
+	}
+
+	int numCells = ( numRows - 1 ) * ( numCols - 1 );
+	m_indexes.clear();
+	m_indexes.reserve( numCells * INDEXES_PER_CELL );
+	m_slotForCell.resize( numCells );
+	m_cellForSlot.resize( numCells );
+	RestoreAllCells();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::RestoreAllCells()
+{
+	m_indexes.clear(); //Keeps its capacity from BuildForGrid, so this never allocates.
+	for ( int r = 0; ( r + 1 ) < m_numRows; r++ )
+	{
+		for ( int c = 0; ( c + 1 ) < m_numCols; c++ )
+		{
+			unsigned int topLeft = ( r * m_numCols ) + c;
+			unsigned int topRight = topLeft + 1;
+			unsigned int bottomLeft = topLeft + m_numCols;
+			unsigned int bottomRight = bottomLeft + 1;
+
+			unsigned int cellIndex = ( r * ( m_numCols - 1 ) ) + c;
+			m_slotForCell[ cellIndex ] = cellIndex;
+			m_cellForSlot[ cellIndex ] = cellIndex;
+
+			//Same winding as the old quads (BL, BR, TR, TL), split along BL-TR.
+			m_indexes.push_back( bottomLeft );
+			m_indexes.push_back( bottomRight );
+			m_indexes.push_back( topRight );
+			m_indexes.push_back( bottomLeft );
+			m_indexes.push_back( topRight );
+			m_indexes.push_back( topLeft );
+		}
+	}
+	m_isIndexBufferDirty = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::RemoveCell( int rowStartTop, int colStartLeft )
+{
+	if ( rowStartTop < 0 || colStartLeft < 0 || ( rowStartTop + 1 ) >= m_numRows || ( colStartLeft + 1 ) >= m_numCols )
+		return; //Bottom row and right column particles don't own a cell.
+
+	unsigned int cellIndex = ( rowStartTop * ( m_numCols - 1 ) ) + colStartLeft;
+	unsigned int slot = m_slotForCell[ cellIndex ];
+	if ( slot == INVALID_SLOT )
+		return;
+
+	//Swap-remove: move the last live cell's indexes into the hole.
+	unsigned int lastSlot = GetNumCells() - 1;
+	unsigned int lastCell = m_cellForSlot[ lastSlot ];
+	for ( unsigned int offset = 0; offset < INDEXES_PER_CELL; ++offset )
+		m_indexes[ ( slot * INDEXES_PER_CELL ) + offset ] = m_indexes[ ( lastSlot * INDEXES_PER_CELL ) + offset ];
+	m_indexes.resize( lastSlot * INDEXES_PER_CELL );
+
+	m_slotForCell[ lastCell ] = slot;
+	m_cellForSlot[ slot ] = lastCell;
+	m_slotForCell[ cellIndex ] = INVALID_SLOT;
+	m_isIndexBufferDirty = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::Update( const ClothParticleStore& particles, float interpolationAlpha, ThreadPool* threadPool )
+{
+	//Two passes: a row's frames read the rows above and below, so every position must be in place before any band starts.
+	ThreadPool::ParallelFor( threadPool, m_vertexes.size(), VERTEXES_PER_TASK, [ this, &particles, interpolationAlpha ]( unsigned int begin, unsigned int end )
+	{
+		const float* startX = particles.m_stepStartPositionX.data();
+		const float* startY = particles.m_stepStartPositionY.data();
+		const float* startZ = particles.m_stepStartPositionZ.data();
+		const float* currentX = particles.m_positionX.data();
+		const float* currentY = particles.m_positionY.data();
+		const float* currentZ = particles.m_positionZ.data();
+		for ( unsigned int index = begin; index < end; ++index )
+		{
+			m_positionX[ index ] = startX[ index ] + ( ( currentX[ index ] - startX[ index ] ) * interpolationAlpha );
+			m_positionY[ index ] = startY[ index ] + ( ( currentY[ index ] - startY[ index ] ) * interpolationAlpha );
+			m_positionZ[ index ] = startZ[ index ] + ( ( currentZ[ index ] - startZ[ index ] ) * interpolationAlpha );
+		}
+	} );
+
+	ThreadPool::ParallelFor( threadPool, m_numRows, ROWS_PER_TASK, [ this ]( unsigned int firstRow, unsigned int endRow )
+	{
+		ComputeTangentFramesForRows( firstRow, endRow );
+		WriteVertexesForRows( firstRow, endRow );
+	} );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::ComputeTangentFrame( unsigned int index, unsigned int left, unsigned int right, unsigned int up, unsigned int down )
+{
+	//U falls from left to right, so +U is the left neighbor minus the right one. V grows downward.
+	float tx = m_positionX[ left ] - m_positionX[ right ];
+	float ty = m_positionY[ left ] - m_positionY[ right ];
+	float tz = m_positionZ[ left ] - m_positionZ[ right ];
+	float bx = m_positionX[ down ] - m_positionX[ up ];
+	float by = m_positionY[ down ] - m_positionY[ up ];
+	float bz = m_positionZ[ down ] - m_positionZ[ up ];
+	float nx = ( ty * bz ) - ( tz * by );
+	float ny = ( tz * bx ) - ( tx * bz );
+	float nz = ( tx * by ) - ( ty * bx );
+
+	float tangentScale = 1.f / sqrtf( ( tx * tx ) + ( ty * ty ) + ( tz * tz ) + MIN_LENGTH_SQUARED );
+	float bitangentScale = 1.f / sqrtf( ( bx * bx ) + ( by * by ) + ( bz * bz ) + MIN_LENGTH_SQUARED );
+	float normalScale = 1.f / sqrtf( ( nx * nx ) + ( ny * ny ) + ( nz * nz ) + MIN_LENGTH_SQUARED );
+
+	m_tangentX[ index ] = tx * tangentScale;
+	m_tangentY[ index ] = ty * tangentScale;
+	m_tangentZ[ index ] = tz * tangentScale;
+	m_bitangentX[ index ] = bx * bitangentScale;
+	m_bitangentY[ index ] = by * bitangentScale;
+	m_bitangentZ[ index ] = bz * bitangentScale;
+	m_normalX[ index ] = nx * normalScale;
+	m_normalY[ index ] = ny * normalScale;
+	m_normalZ[ index ] = nz * normalScale;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::ComputeTangentFramesForRows( int firstRow, int endRow )
+{
+	//Central differences inside the grid, one-sided on its border.
+	for ( int r = firstRow; r < endRow; r++ )
+	{
+		const unsigned int rowStart = r * m_numCols;
+		const unsigned int upRowStart = ( ( r > 0 ) ? ( r - 1 ) : r ) * m_numCols;
+		const unsigned int downRowStart = ( ( ( r + 1 ) < m_numRows ) ? ( r + 1 ) : r ) * m_numCols;
+		const int lastCol = m_numCols - 1;
+
+		ComputeTangentFrame( rowStart, rowStart, rowStart + ( ( lastCol > 0 ) ? 1 : 0 ), upRowStart, downRowStart );
+		int c = 1;
+
+#if defined( CLOTH_MESH_SSE )
+		//Interior columns, 4 at a time: left/right neighbors are the same row shifted by one, up/down are the adjacent rows.
+		const __m128 minLengthSquared = _mm_set1_ps( MIN_LENGTH_SQUARED );
+		const __m128 one = _mm_set1_ps( 1.f );
+		for ( ; c + 4 <= lastCol; c += 4 )
+		{
+			const unsigned int i = rowStart + c;
+			const unsigned int u = upRowStart + c;
+			const unsigned int d = downRowStart + c;
+
+			__m128 tx = _mm_sub_ps( _mm_loadu_ps( &m_positionX[ i - 1 ] ), _mm_loadu_ps( &m_positionX[ i + 1 ] ) );
+			__m128 ty = _mm_sub_ps( _mm_loadu_ps( &m_positionY[ i - 1 ] ), _mm_loadu_ps( &m_positionY[ i + 1 ] ) );
+			__m128 tz = _mm_sub_ps( _mm_loadu_ps( &m_positionZ[ i - 1 ] ), _mm_loadu_ps( &m_positionZ[ i + 1 ] ) );
+			__m128 bx = _mm_sub_ps( _mm_loadu_ps( &m_positionX[ d ] ), _mm_loadu_ps( &m_positionX[ u ] ) );
+			__m128 by = _mm_sub_ps( _mm_loadu_ps( &m_positionY[ d ] ), _mm_loadu_ps( &m_positionY[ u ] ) );
+			__m128 bz = _mm_sub_ps( _mm_loadu_ps( &m_positionZ[ d ] ), _mm_loadu_ps( &m_positionZ[ u ] ) );
+			__m128 nx = _mm_sub_ps( _mm_mul_ps( ty, bz ), _mm_mul_ps( tz, by ) );
+			__m128 ny = _mm_sub_ps( _mm_mul_ps( tz, bx ), _mm_mul_ps( tx, bz ) );
+			__m128 nz = _mm_sub_ps( _mm_mul_ps( tx, by ), _mm_mul_ps( ty, bx ) );
+
+			//Full-precision sqrt and divide, so the SIMD columns match the scalar border exactly.
+			__m128 tangentScale = _mm_div_ps( one, _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( tx, tx ), _mm_mul_ps( ty, ty ) ), _mm_mul_ps( tz, tz ) ), minLengthSquared ) ) );
+			__m128 bitangentScale = _mm_div_ps( one, _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( bx, bx ), _mm_mul_ps( by, by ) ), _mm_mul_ps( bz, bz ) ), minLengthSquared ) ) );
+			__m128 normalScale = _mm_div_ps( one, _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, nx ), _mm_mul_ps( ny, ny ) ), _mm_mul_ps( nz, nz ) ), minLengthSquared ) ) );
+
+			_mm_storeu_ps( &m_tangentX[ i ], _mm_mul_ps( tx, tangentScale ) );
+			_mm_storeu_ps( &m_tangentY[ i ], _mm_mul_ps( ty, tangentScale ) );
+			_mm_storeu_ps( &m_tangentZ[ i ], _mm_mul_ps( tz, tangentScale ) );
+			_mm_storeu_ps( &m_bitangentX[ i ], _mm_mul_ps( bx, bitangentScale ) );
+			_mm_storeu_ps( &m_bitangentY[ i ], _mm_mul_ps( by, bitangentScale ) );
+			_mm_storeu_ps( &m_bitangentZ[ i ], _mm_mul_ps( bz, bitangentScale ) );
+			_mm_storeu_ps( &m_normalX[ i ], _mm_mul_ps( nx, normalScale ) );
+			_mm_storeu_ps( &m_normalY[ i ], _mm_mul_ps( ny, normalScale ) );
+			_mm_storeu_ps( &m_normalZ[ i ], _mm_mul_ps( nz, normalScale ) );
+		}
+#endif
+
+		for ( ; c < lastCol; c++ )
+			ComputeTangentFrame( rowStart + c, rowStart + c - 1, rowStart + c + 1, upRowStart + c, downRowStart + c );
+
+		if ( lastCol > 0 )
+			ComputeTangentFrame( rowStart + lastCol, rowStart + lastCol - 1, rowStart + lastCol, upRowStart + lastCol, downRowStart + lastCol );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::WriteVertexesForRows( int firstRow, int endRow )
+{
+	//Two-sided Lambert into the vertex color, since TheRenderer's fixed-function path has no lighting of its own.
+	const unsigned int begin = firstRow * m_numCols;
+	const unsigned int end = endRow * m_numCols;
+	for ( unsigned int index = begin; index < end; ++index )
+	{
+		float facing = ( m_normalX[ index ] * LIGHT_DIRECTION.x ) + ( m_normalY[ index ] * LIGHT_DIRECTION.y ) + ( m_normalZ[ index ] * LIGHT_DIRECTION.z );
+		float brightness = AMBIENT_LIGHT + ( ( 1.f - AMBIENT_LIGHT ) * fabsf( facing ) );
+		unsigned char shade = static_cast<unsigned char>( 255.f * brightness );
+
+		Vertex_PCT& vertex = m_vertexes[ index ];
+		vertex.pos.x = m_positionX[ index ];
+		vertex.pos.y = m_positionY[ index ];
+		vertex.pos.z = m_positionZ[ index ];
+		vertex.color.red = shade;
+		vertex.color.green = shade;
+		vertex.color.blue = shade;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::CopyToVertexPCUTB( std::vector<Vertex_PCUTB>& out_vertexes ) const
+{
+	out_vertexes.resize( m_vertexes.size() );
+	for ( unsigned int index = 0; index < m_vertexes.size(); ++index )
+	{
+		out_vertexes[ index ] = Vertex_PCUTB( m_vertexes[ index ].pos, RGBA::WHITE, m_vertexes[ index ].texCoords,
+											  Vector3( m_tangentX[ index ], m_tangentY[ index ], m_tangentZ[ index ] ),
+											  Vector3( m_bitangentX[ index ], m_bitangentY[ index ], m_bitangentZ[ index ] ) );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothMesh::Render( Texture* texture )
+{
+	if ( TheRenderer::instance == nullptr || m_indexes.empty() )
+		return;
+
+	if ( m_vboID == 0 )
+	{
+		m_vboID = TheRenderer::instance->GenerateBufferID();
+		m_iboID = TheRenderer::instance->GenerateBufferID();
+	}
+
+	if ( m_isIndexBufferDirty ) //Only after BuildForGrid or a cell was shot out.
+	{
+		TheRenderer::instance->BindAndBufferIBOData( m_iboID, m_indexes.data(), m_indexes.size() );
+		m_isIndexBufferDirty = false;
+	}
+
+	TheRenderer::instance->BindAndBufferStreamingVBOData( m_vboID, m_vertexes.data(), m_vertexes.size() );
+	TheRenderer::instance->DrawIndexedVBO_PCT( m_vboID, m_iboID, m_indexes.size(), TheRenderer::TRIANGLES, texture );
+}
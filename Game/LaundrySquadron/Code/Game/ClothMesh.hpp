@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include "Engine/Renderer/Vertex.hpp"
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+class Texture;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+//Persistent render mesh for a cloth grid: one vertex per particle with UVs set once at build time,
+//and two triangles per live cell in an index list. Per frame only positions and tangent frames are refreshed, then drawn in one call.
+class ClothMesh
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothMesh();
+	~ClothMesh();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void BuildForGrid( int numRows, int numCols );
+	void RemoveCell( int rowStartTop, int colStartLeft ); //Cell (r,c) spans particles (r,c) to (r+1,c+1). No-op if already removed or off the grid.
+	unsigned int GetNumCells() const { return m_indexes.size() / INDEXES_PER_CELL; }
+	unsigned int GetNumGridCells() const { return m_slotForCell.size(); } //Live or not. Cell (r,c) is grid cell ( r * ( numCols - 1 ) ) + c.
+	bool IsGridCellRemoved( unsigned int cellIndex ) const { return m_slotForCell[ cellIndex ] == INVALID_SLOT; }
+	void RestoreAllCells(); //Undoes every RemoveCell since BuildForGrid.
+	//Lerps each vertex between the last two fixed steps, then rebuilds tangent frames and lighting in row bands across threadPool (may be nullptr).
+	void Update( const ClothParticleStore& particles, float interpolationAlpha, ThreadPool* threadPool );
+	void Render( Texture* texture );
+	void CopyToVertexPCUTB( std::vector<Vertex_PCUTB>& out_vertexes ) const; //Positions, UVs and tangent frames for Material's normal-mapped path.
+	Vector3 GetNormal( unsigned int vertexIndex ) const { return Vector3( m_normalX[ vertexIndex ], m_normalY[ vertexIndex ], m_normalZ[ vertexIndex ] ); }
+
+
+private:
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int INDEXES_PER_CELL = 6;
+	static const unsigned int INVALID_SLOT = 0xFFFFFFFF;
+	static const unsigned int VERTEXES_PER_TASK = 4096;
+	static const unsigned int ROWS_PER_TASK = 16;
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void ComputeTangentFramesForRows( int firstRow, int endRow );
+	void ComputeTangentFrame( unsigned int index, unsigned int left, unsigned int right, unsigned int up, unsigned int down ); //Scalar path for edges and tails.
+	void WriteVertexesForRows( int firstRow, int endRow );
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	int m_numRows;
+	int m_numCols;
+	std::vector<Vertex_PCT> m_vertexes; //Row-major, same order as the cloth's particles.
+
+	//Interpolated positions and per-vertex tangent frames, SoA so whole rows are processed 4 columns at a time.
+	//Tangent points along +U, bitangent along +V, normal = Cross( tangent, bitangent ), all unit length.
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	std::vector<float> m_tangentX;
+	std::vector<float> m_tangentY;
+	std::vector<float> m_tangentZ;
+	std::vector<float> m_bitangentX;
+	std::vector<float> m_bitangentY;
+	std::vector<float> m_bitangentZ;
+	std::vector<float> m_normalX;
+	std::vector<float> m_normalY;
+	std::vector<float> m_normalZ;
+
+	std::vector<unsigned int> m_indexes; //INDEXES_PER_CELL per live cell, in no particular cell order.
+	std::vector<unsigned int> m_slotForCell; //Where each cell's indexes start in m_indexes / INDEXES_PER_CELL, or INVALID_SLOT once removed.
+	std::vector<unsigned int> m_cellForSlot; //Inverse of m_slotForCell, so RemoveCell can swap the last cell into the hole.
+	int m_vboID; //0 until the first Render, so a cloth can be built before the renderer exists.
+	int m_iboID;
+	bool m_isIndexBufferDirty;
+};
@@ -0,0 +1,140 @@
+#include "Game/ClothParticleStore.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+//One axis at a time, with no branches, so the compiler can vectorize the loop.
+static void IntegrateVerletAxis( float* position, float* previousPosition, const float* acceleration, unsigned int begin, unsigned int end, float deltaSecondsSquared )
+{
+	for ( unsigned int index = begin; index < end; index++ )
+	{
+		float currentPosition = position[ index ];
+		position[ index ] = currentPosition + ( currentPosition - previousPosition[ index ] ) + ( acceleration[ index ] * deltaSecondsSquared );
+		previousPosition[ index ] = currentPosition;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void UpdateVelocityAxis( float* velocity, const float* position, const float* previousPosition, unsigned int begin, unsigned int end, float inverseDeltaSeconds )
+{
+	for ( unsigned int index = begin; index < end; index++ )
+		velocity[ index ] = ( position[ index ] - previousPosition[ index ] ) * inverseDeltaSeconds;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::Resize( unsigned int numParticles )
+{
+	m_numParticles = numParticles;
+
+	m_positionX.assign( numParticles, 0.f );
+	m_positionY.assign( numParticles, 0.f );
+	m_positionZ.assign( numParticles, 0.f );
+	m_previousPositionX.assign( numParticles, 0.f );
+	m_previousPositionY.assign( numParticles, 0.f );
+	m_previousPositionZ.assign( numParticles, 0.f );
+	m_stepStartPositionX.assign( numParticles, 0.f );
+	m_stepStartPositionY.assign( numParticles, 0.f );
+	m_stepStartPositionZ.assign( numParticles, 0.f );
+	m_velocityX.assign( numParticles, 0.f );
+	m_velocityY.assign( numParticles, 0.f );
+	m_velocityZ.assign( numParticles, 0.f );
+	m_accelerationX.assign( numParticles, 0.f );
+	m_accelerationY.assign( numParticles, 0.f );
+	m_accelerationZ.assign( numParticles, 0.f );
+	m_inverseMass.assign( numParticles, 1.f );
+	m_flags.assign( numParticles, 0 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::SetPosition( unsigned int index, const Vector3& newPosition )
+{
+	m_positionX[ index ] = newPosition.x;
+	m_positionY[ index ] = newPosition.y;
+	m_positionZ[ index ] = newPosition.z;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::SetPreviousPosition( unsigned int index, const Vector3& newPosition )
+{
+	m_previousPositionX[ index ] = newPosition.x;
+	m_previousPositionY[ index ] = newPosition.y;
+	m_previousPositionZ[ index ] = newPosition.z;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector3 ClothParticleStore::GetInterpolatedPosition( unsigned int index, float alpha ) const
+{
+	return Vector3( m_stepStartPositionX[ index ] + ( ( m_positionX[ index ] - m_stepStartPositionX[ index ] ) * alpha ),
+					m_stepStartPositionY[ index ] + ( ( m_positionY[ index ] - m_stepStartPositionY[ index ] ) * alpha ),
+					m_stepStartPositionZ[ index ] + ( ( m_positionZ[ index ] - m_stepStartPositionZ[ index ] ) * alpha ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::SetStepStartPosition( unsigned int index, const Vector3& newPosition )
+{
+	m_stepStartPositionX[ index ] = newPosition.x;
+	m_stepStartPositionY[ index ] = newPosition.y;
+	m_stepStartPositionZ[ index ] = newPosition.z;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::SaveStepStartPositions()
+{
+	m_stepStartPositionX = m_positionX;
+	m_stepStartPositionY = m_positionY;
+	m_stepStartPositionZ = m_positionZ;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::SetVelocity( unsigned int index, const Vector3& newVelocity )
+{
+	m_velocityX[ index ] = newVelocity.x;
+	m_velocityY[ index ] = newVelocity.y;
+	m_velocityZ[ index ] = newVelocity.z;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::Translate( unsigned int index, const Vector3& translation )
+{
+	m_positionX[ index ] += translation.x;
+	m_positionY[ index ] += translation.y;
+	m_positionZ[ index ] += translation.z;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::IntegrateVerlet( unsigned int begin, unsigned int end, float deltaSeconds )
+{
+	const float deltaSecondsSquared = deltaSeconds * deltaSeconds;
+	IntegrateVerletAxis( m_positionX.data(), m_previousPositionX.data(), m_accelerationX.data(), begin, end, deltaSecondsSquared );
+	IntegrateVerletAxis( m_positionY.data(), m_previousPositionY.data(), m_accelerationY.data(), begin, end, deltaSecondsSquared );
+	IntegrateVerletAxis( m_positionZ.data(), m_previousPositionZ.data(), m_accelerationZ.data(), begin, end, deltaSecondsSquared );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::UpdateVelocitiesFromPositions( unsigned int begin, unsigned int end, float deltaSeconds )
+{
+	const float inverseDeltaSeconds = 1.f / deltaSeconds;
+	UpdateVelocityAxis( m_velocityX.data(), m_positionX.data(), m_previousPositionX.data(), begin, end, inverseDeltaSeconds );
+	UpdateVelocityAxis( m_velocityY.data(), m_positionY.data(), m_previousPositionY.data(), begin, end, inverseDeltaSeconds );
+	UpdateVelocityAxis( m_velocityZ.data(), m_positionZ.data(), m_previousPositionZ.data(), begin, end, inverseDeltaSeconds );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothParticleStore::SetFlag( unsigned int index, ClothParticleFlag flag, bool newVal )
+{
+	if ( newVal )
+		m_flags[ index ] |= flag;
+	else
+		m_flags[ index ] &= ~flag;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include "Engine/Math/Vector3.hpp"
+
+
+//-----------------------------------------------------------------------------
+enum ClothParticleFlag : unsigned char
+{
+	CLOTH_PARTICLE_EXPIRED = 1 << 0,
+	CLOTH_PARTICLE_PINNED = 1 << 1
+};
+
+
+//-----------------------------------------------------------------------------
+//Structure-of-arrays storage for every particle of a cloth: one contiguous array per component,
+//so the integrator and constraint solver stream through memory instead of chasing a heap state per particle.
+class ClothParticleStore
+{
+public:
+
+	ClothParticleStore()
+		: m_numParticles( 0 )
+	{
+	}
+
+	void Resize( unsigned int numParticles );
+	unsigned int GetNumParticles() const { return m_numParticles; }
+
+	Vector3 GetPosition( unsigned int index ) const { return Vector3( m_positionX[ index ], m_positionY[ index ], m_positionZ[ index ] ); }
+	Vector3 GetPreviousPosition( unsigned int index ) const { return Vector3( m_previousPositionX[ index ], m_previousPositionY[ index ], m_previousPositionZ[ index ] ); }
+	Vector3 GetStepStartPosition( unsigned int index ) const { return Vector3( m_stepStartPositionX[ index ], m_stepStartPositionY[ index ], m_stepStartPositionZ[ index ] ); }
+	Vector3 GetInterpolatedPosition( unsigned int index, float alpha ) const; //Lerps from the step-start position to the current one.
+	Vector3 GetVelocity( unsigned int index ) const { return Vector3( m_velocityX[ index ], m_velocityY[ index ], m_velocityZ[ index ] ); }
+	void SetPosition( unsigned int index, const Vector3& newPosition );
+	void SetPreviousPosition( unsigned int index, const Vector3& newPosition );
+	void SetStepStartPosition( unsigned int index, const Vector3& newPosition );
+	void SetVelocity( unsigned int index, const Vector3& newVelocity );
+	void Translate( unsigned int index, const Vector3& translation );
+
+	void SaveStepStartPositions(); //Call before each fixed step, so rendering can interpolate across it.
+
+	//Position Verlet over [begin, end): x' := x + ( x - x_prev ) + a*dt*dt, x_prev := x. Reads m_acceleration, one flat pass per axis.
+	void IntegrateVerlet( unsigned int begin, unsigned int end, float deltaSeconds );
+	//v := ( x - x_prev ) / dt, so velocities include whatever the constraint solver moved since IntegrateVerlet.
+	void UpdateVelocitiesFromPositions( unsigned int begin, unsigned int end, float deltaSeconds );
+
+	bool IsExpired( unsigned int index ) const { return ( m_flags[ index ] & CLOTH_PARTICLE_EXPIRED ) != 0; }
+	void SetIsExpired( unsigned int index, bool newVal ) { SetFlag( index, CLOTH_PARTICLE_EXPIRED, newVal ); }
+	bool IsPinned( unsigned int index ) const { return ( m_flags[ index ] & CLOTH_PARTICLE_PINNED ) != 0; }
+	void SetIsPinned( unsigned int index, bool newVal ) { SetFlag( index, CLOTH_PARTICLE_PINNED, newVal ); }
+
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	std::vector<float> m_previousPositionX; //Position at the start of the last step.
+	std::vector<float> m_previousPositionY;
+	std::vector<float> m_previousPositionZ;
+	std::vector<float> m_stepStartPositionX; //Position before the last whole fixed step (which may span several substeps).
+	std::vector<float> m_stepStartPositionY;
+	std::vector<float> m_stepStartPositionZ;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_velocityZ;
+	std::vector<float> m_accelerationX; //Net force * inverse mass for the coming step, written before IntegrateVerlet.
+	std::vector<float> m_accelerationY;
+	std::vector<float> m_accelerationZ;
+	std::vector<float> m_inverseMass; //0 for pinned particles, so neither forces nor constraints move them.
+	std::vector<unsigned char> m_flags; //ClothParticleFlag bits.
+
+
+private:
+
+	void SetFlag( unsigned int index, ClothParticleFlag flag, bool newVal );
+
+	unsigned int m_numParticles;
+};
@@ -0,0 +1,183 @@
+#include "Game/ClothSelfCollision.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Game/ClothConstraints.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include <cmath>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const float MIN_DISTANCE_SQUARED = 1e-12f; //Coincident particles have no direction to separate along; leave them to the next step.
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothSelfCollision::ClothSelfCollision()
+	: m_thickness( .5f )
+	, m_numContactsLastSolve( 0 )
+	, m_tableMask( 0 )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ClothSelfCollision::HashCell( int x, int y, int z ) const
+{
+	return ( ( (unsigned int)x * 73856093u ) ^ ( (unsigned int)y * 19349663u ) ^ ( (unsigned int)z * 83492791u ) ) & m_tableMask;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSelfCollision::BuildHash( const ClothParticleStore& particles, ThreadPool* threadPool )
+{
+	unsigned int numParticles = particles.GetNumParticles();
+	unsigned int tableSize = 1;
+	while ( tableSize < numParticles * 2 )
+		tableSize <<= 1;
+	m_tableMask = tableSize - 1;
+
+	m_cellOfParticle.resize( numParticles );
+	m_sortedParticles.resize( numParticles );
+	m_cellStart.assign( tableSize + 1, 0 );
+
+	float inverseCellSize = .5f / m_thickness;
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, &particles, inverseCellSize ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int particleIndex = begin; particleIndex < end; particleIndex++ )
+		{
+			m_cellOfParticle[ particleIndex ] = HashCell( (int)floorf( particles.m_positionX[ particleIndex ] * inverseCellSize ),
+														  (int)floorf( particles.m_positionY[ particleIndex ] * inverseCellSize ),
+														  (int)floorf( particles.m_positionZ[ particleIndex ] * inverseCellSize ) );
+		}
+	} );
+
+	//Counting sort by bucket. A few flat passes, far cheaper than the gather that follows.
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; particleIndex++ )
+		++m_cellStart[ m_cellOfParticle[ particleIndex ] ];
+	for ( unsigned int bucket = 1; bucket < tableSize; bucket++ )
+		m_cellStart[ bucket ] += m_cellStart[ bucket - 1 ]; //Now the end of each bucket...
+	m_cellStart[ tableSize ] = numParticles;
+	for ( unsigned int particleIndex = numParticles; particleIndex-- > 0; )
+		m_sortedParticles[ --m_cellStart[ m_cellOfParticle[ particleIndex ] ] ] = particleIndex; //...and, once filled back to front, its start.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSelfCollision::Solve( ClothParticleStore& particles, const ClothConstraintSet& constraints, ThreadPool* threadPool )
+{
+	unsigned int numParticles = particles.GetNumParticles();
+	m_numContactsLastSolve = 0;
+	if ( numParticles == 0 || m_thickness <= 0.f )
+		return;
+
+	BuildHash( particles, threadPool );
+
+	m_correctionX.resize( numParticles );
+	m_correctionY.resize( numParticles );
+	m_correctionZ.resize( numParticles );
+	m_chunkContacts.assign( ( numParticles + PARTICLES_PER_TASK - 1 ) / PARTICLES_PER_TASK, 0 );
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, &particles, &constraints ]( unsigned int begin, unsigned int end )
+	{
+		unsigned int numContacts = 0;
+		for ( unsigned int particleIndex = begin; particleIndex < end; particleIndex++ )
+			numContacts += GatherCorrection( particleIndex, particles, constraints );
+		m_chunkContacts[ begin / PARTICLES_PER_TASK ] = numContacts;
+	} );
+
+	ThreadPool::ParallelFor( threadPool, numParticles, PARTICLES_PER_TASK, [ this, &particles ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int particleIndex = begin; particleIndex < end; particleIndex++ )
+		{
+			particles.m_positionX[ particleIndex ] += m_correctionX[ particleIndex ];
+			particles.m_positionY[ particleIndex ] += m_correctionY[ particleIndex ];
+			particles.m_positionZ[ particleIndex ] += m_correctionZ[ particleIndex ];
+		}
+	} );
+
+	for ( unsigned int chunkContacts : m_chunkContacts )
+		m_numContactsLastSolve += chunkContacts;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ClothSelfCollision::GatherCorrection( unsigned int particleIndex, const ClothParticleStore& particles, const ClothConstraintSet& constraints )
+{
+	m_correctionX[ particleIndex ] = 0.f;
+	m_correctionY[ particleIndex ] = 0.f;
+	m_correctionZ[ particleIndex ] = 0.f;
+
+	float inverseMass = particles.m_inverseMass[ particleIndex ];
+	if ( inverseMass == 0.f )
+		return 0;
+
+	float x = particles.m_positionX[ particleIndex ];
+	float y = particles.m_positionY[ particleIndex ];
+	float z = particles.m_positionZ[ particleIndex ];
+	//Cells are two thicknesses wide, so everything within one thickness is in the 2x2x2 block of cells nearest the particle.
+	float inverseCellSize = .5f / m_thickness;
+	float cellCoordX = x * inverseCellSize;
+	float cellCoordY = y * inverseCellSize;
+	float cellCoordZ = z * inverseCellSize;
+	int firstCellX = (int)floorf( cellCoordX - .5f );
+	int firstCellY = (int)floorf( cellCoordY - .5f );
+	int firstCellZ = (int)floorf( cellCoordZ - .5f );
+	float thicknessSquared = m_thickness * m_thickness;
+
+	//Neighboring cells can hash to the same bucket; visit each bucket once or its particles would push twice.
+	unsigned int visitedBuckets[ 8 ];
+	unsigned int numVisitedBuckets = 0;
+
+	float sumX = 0.f;
+	float sumY = 0.f;
+	float sumZ = 0.f;
+	unsigned int numContacts = 0;
+	for ( int offsetX = 0; offsetX <= 1; offsetX++ )
+	{
+		for ( int offsetY = 0; offsetY <= 1; offsetY++ )
+		{
+			for ( int offsetZ = 0; offsetZ <= 1; offsetZ++ )
+			{
+				unsigned int bucket = HashCell( firstCellX + offsetX, firstCellY + offsetY, firstCellZ + offsetZ );
+				bool isVisited = false;
+				for ( unsigned int visitedIndex = 0; visitedIndex < numVisitedBuckets && !isVisited; visitedIndex++ )
+					isVisited = ( visitedBuckets[ visitedIndex ] == bucket );
+				if ( isVisited )
+					continue;
+				visitedBuckets[ numVisitedBuckets++ ] = bucket;
+
+				for ( unsigned int sortedIndex = m_cellStart[ bucket ]; sortedIndex < m_cellStart[ bucket + 1 ]; sortedIndex++ )
+				{
+					unsigned int otherIndex = m_sortedParticles[ sortedIndex ];
+					if ( otherIndex == particleIndex )
+						continue;
+
+					float dx = x - particles.m_positionX[ otherIndex ];
+					float dy = y - particles.m_positionY[ otherIndex ];
+					float dz = z - particles.m_positionZ[ otherIndex ];
+					float distanceSquared = ( dx * dx ) + ( dy * dy ) + ( dz * dz );
+					if ( distanceSquared >= thicknessSquared || distanceSquared < MIN_DISTANCE_SQUARED )
+						continue;
+					if ( constraints.AreParticlesConnected( particleIndex, otherIndex ) )
+						continue;
+
+					//This particle's share of the overlap, by inverse mass; the other particle takes the rest when it gathers.
+					float distance = sqrtf( distanceSquared );
+					float share = inverseMass / ( inverseMass + particles.m_inverseMass[ otherIndex ] );
+					float scale = share * ( m_thickness - distance ) / distance;
+					sumX += dx * scale;
+					sumY += dy * scale;
+					sumZ += dz * scale;
+					++numContacts;
+				}
+			}
+		}
+	}
+
+	if ( numContacts > 0 )
+	{
+		//Averaging keeps a particle squeezed from many sides from being shot out by the sum of its pushes.
+		float inverseNumContacts = 1.f / (float)numContacts;
+		m_correctionX[ particleIndex ] = sumX * inverseNumContacts;
+		m_correctionY[ particleIndex ] = sumY * inverseNumContacts;
+		m_correctionZ[ particleIndex ] = sumZ * inverseNumContacts;
+	}
+	return numContacts;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+class ClothConstraintSet;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+//Particle-particle self-collision for a cloth. Each Solve rebuilds a spatial hash with cells two thicknesses wide,
+//so every pair closer than the thickness is found in the 8 cells nearest a particle, then pushes such pairs apart.
+//Pairs joined by a constraint are skipped: their spacing is the constraint solver's job.
+class ClothSelfCollision
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothSelfCollision();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	//Jacobi-style: every particle gathers its own averaged push from the current positions, then all pushes are applied,
+	//so the result doesn't depend on thread count or order. O(particles) per call while the cloth isn't crushed into a single cell.
+	void Solve( ClothParticleStore& particles, const ClothConstraintSet& constraints, ThreadPool* threadPool );
+	void SetThickness( float thickness ) { m_thickness = thickness; } //Minimum distance kept between unconnected particles.
+	float GetThickness() const { return m_thickness; }
+	unsigned int GetNumContactsLastSolve() const { return m_numContactsLastSolve; } //Each pair counts twice, once per side.
+
+
+private:
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int PARTICLES_PER_TASK = 1024;
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void BuildHash( const ClothParticleStore& particles, ThreadPool* threadPool );
+	unsigned int GatherCorrection( unsigned int particleIndex, const ClothParticleStore& particles, const ClothConstraintSet& constraints ); //Returns its contact count.
+	unsigned int HashCell( int x, int y, int z ) const;
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	float m_thickness;
+	unsigned int m_numContactsLastSolve;
+	unsigned int m_tableMask; //Table size is a power of two, at least twice the particle count.
+	std::vector<unsigned int> m_cellOfParticle;
+	std::vector<unsigned int> m_cellStart; //Bucket h holds m_sortedParticles[ m_cellStart[ h ], m_cellStart[ h + 1 ] ).
+	std::vector<unsigned int> m_sortedParticles;
+	std::vector<float> m_correctionX;
+	std::vector<float> m_correctionY;
+	std::vector<float> m_correctionZ;
+	std::vector<unsigned int> m_chunkContacts; //Per task, summed in order after the gather.
+};
@@ -0,0 +1,287 @@
+#include "Game/ClothSleep.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include <cmath>
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothSleep::ClothSleep()
+	: m_numRows( 0 )
+	, m_numCols( 0 )
+	, m_numTileRows( 0 )
+	, m_numTileCols( 0 )
+	, m_sleepDistance( .001f )
+	, m_numStillUpdatesToSleep( DEFAULT_NUM_STILL_UPDATES_TO_SLEEP )
+	, m_numSleepingTiles( 0 )
+	, m_areAwakeRangesDirty( true )
+	, m_areAwakeBatchesDirty( true )
+	, m_awakeBatchesRevision( 0 )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSleep::BuildForGrid( int numRows, int numCols )
+{
+	m_numRows = numRows;
+	m_numCols = numCols;
+	m_numTileRows = ( numRows + TILE_SIZE - 1 ) / TILE_SIZE;
+	m_numTileCols = ( numCols + TILE_SIZE - 1 ) / TILE_SIZE;
+
+	unsigned int numTiles = m_numTileRows * m_numTileCols;
+	m_isTileAsleep.assign( numTiles, 0 );
+	m_numStillUpdates.assign( numTiles, 0 );
+	m_tileDisplacement.assign( numTiles, 0.f );
+	m_tileMins.assign( numTiles, Vector3::ZERO );
+	m_tileMaxs.assign( numTiles, Vector3::ZERO );
+	m_inverseMassBeforeSleep.assign( numRows * numCols, 0.f );
+	m_numSleepingTiles = 0;
+	m_areAwakeRangesDirty = true;
+	m_areAwakeBatchesDirty = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSleep::Update( ClothParticleStore& particles, const ClothConstraintSet& constraints, ThreadPool* threadPool )
+{
+	ThreadPool::ParallelFor( threadPool, m_isTileAsleep.size(), TILES_PER_TASK, [ this, &particles, &constraints ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int tileIndex = begin; tileIndex < end; ++tileIndex )
+			m_tileDisplacement[ tileIndex ] = ( m_isTileAsleep[ tileIndex ] != 0 ) ? 0.f : MeasureTileDisplacement( tileIndex, particles, constraints );
+	} );
+
+	//Decide serially from the measurements alone, so which tiles change state doesn't depend on thread count or visiting order.
+	//A tile judges its whole 3x3 neighborhood: it sleeps once every tile around it is still too, and wakes as soon as one moves.
+	m_tilesToWake.clear();
+	for ( int tileRow = 0; tileRow < m_numTileRows; ++tileRow )
+	{
+		for ( int tileCol = 0; tileCol < m_numTileCols; ++tileCol )
+		{
+			float neighborhoodDisplacement = 0.f;
+			for ( int neighborRow = tileRow - 1; neighborRow <= tileRow + 1; ++neighborRow )
+			{
+				for ( int neighborCol = tileCol - 1; neighborCol <= tileCol + 1; ++neighborCol )
+				{
+					if ( neighborRow < 0 || neighborRow >= m_numTileRows || neighborCol < 0 || neighborCol >= m_numTileCols )
+						continue;
+					float neighborDisplacement = m_tileDisplacement[ ( neighborRow * m_numTileCols ) + neighborCol ];
+					neighborhoodDisplacement = ( neighborDisplacement > neighborhoodDisplacement ) ? neighborDisplacement : neighborhoodDisplacement;
+				}
+			}
+
+			unsigned int tileIndex = ( tileRow * m_numTileCols ) + tileCol;
+			bool isStill = neighborhoodDisplacement < m_sleepDistance;
+			if ( m_isTileAsleep[ tileIndex ] != 0 )
+			{
+				if ( !isStill )
+					m_tilesToWake.push_back( tileIndex ); //After the loop, so a tile woken here doesn't count as moving for the tiles after it.
+			}
+			else if ( !isStill )
+			{
+				m_numStillUpdates[ tileIndex ] = 0;
+			}
+			else if ( ++m_numStillUpdates[ tileIndex ] >= m_numStillUpdatesToSleep )
+			{
+				SleepTile( tileIndex, particles );
+			}
+		}
+	}
+
+	for ( unsigned int tileIndex : m_tilesToWake )
+		WakeTile( tileIndex, particles );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+float ClothSleep::MeasureTileDisplacement( unsigned int tileIndex, const ClothParticleStore& particles, const ClothConstraintSet& constraints ) const
+{
+	int firstRow = ( tileIndex / m_numTileCols ) * TILE_SIZE;
+	int firstCol = ( tileIndex % m_numTileCols ) * TILE_SIZE;
+	int lastRow = ( firstRow + TILE_SIZE < m_numRows ) ? firstRow + TILE_SIZE : m_numRows;
+	int lastCol = ( firstCol + TILE_SIZE < m_numCols ) ? firstCol + TILE_SIZE : m_numCols;
+
+	float maxDistanceSquared = 0.f;
+	for ( int row = firstRow; row < lastRow; ++row )
+	{
+		for ( int col = firstCol; col < lastCol; ++col )
+		{
+			unsigned int particleIndex = ( row * m_numCols ) + col;
+			if ( particles.IsExpired( particleIndex ) && !constraints.HasConstraints( particleIndex ) )
+				continue; //Loose debris falls forever. It freezes with its tile rather than keep the tile awake.
+
+			float dx = particles.m_positionX[ particleIndex ] - particles.m_stepStartPositionX[ particleIndex ];
+			float dy = particles.m_positionY[ particleIndex ] - particles.m_stepStartPositionY[ particleIndex ];
+			float dz = particles.m_positionZ[ particleIndex ] - particles.m_stepStartPositionZ[ particleIndex ];
+			float distanceSquared = ( dx * dx ) + ( dy * dy ) + ( dz * dz );
+			maxDistanceSquared = ( distanceSquared > maxDistanceSquared ) ? distanceSquared : maxDistanceSquared;
+		}
+	}
+	return sqrtf( maxDistanceSquared );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSleep::SleepTile( unsigned int tileIndex, ClothParticleStore& particles )
+{
+	int firstRow = ( tileIndex / m_numTileCols ) * TILE_SIZE;
+	int firstCol = ( tileIndex % m_numTileCols ) * TILE_SIZE;
+	int lastRow = ( firstRow + TILE_SIZE < m_numRows ) ? firstRow + TILE_SIZE : m_numRows;
+	int lastCol = ( firstCol + TILE_SIZE < m_numCols ) ? firstCol + TILE_SIZE : m_numCols;
+
+	Vector3 mins = particles.GetPosition( ( firstRow * m_numCols ) + firstCol );
+	Vector3 maxs = mins;
+	for ( int row = firstRow; row < lastRow; ++row )
+	{
+		for ( int col = firstCol; col < lastCol; ++col )
+		{
+			unsigned int particleIndex = ( row * m_numCols ) + col;
+			//Zero inverse mass keeps every solver from moving it; matching previous and step-start positions keep Verlet and Render from seeing motion.
+			m_inverseMassBeforeSleep[ particleIndex ] = particles.m_inverseMass[ particleIndex ];
+			particles.m_inverseMass[ particleIndex ] = 0.f;
+			Vector3 position = particles.GetPosition( particleIndex );
+			particles.SetPreviousPosition( particleIndex, position );
+			particles.SetStepStartPosition( particleIndex, position );
+			particles.SetVelocity( particleIndex, Vector3::ZERO );
+
+			mins = Vector3( fminf( mins.x, position.x ), fminf( mins.y, position.y ), fminf( mins.z, position.z ) );
+			maxs = Vector3( fmaxf( maxs.x, position.x ), fmaxf( maxs.y, position.y ), fmaxf( maxs.z, position.z ) );
+		}
+	}
+
+	m_tileMins[ tileIndex ] = mins;
+	m_tileMaxs[ tileIndex ] = maxs;
+	m_isTileAsleep[ tileIndex ] = 1;
+	++m_numSleepingTiles;
+	m_areAwakeRangesDirty = true;
+	m_areAwakeBatchesDirty = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSleep::WakeTile( unsigned int tileIndex, ClothParticleStore& particles )
+{
+	if ( m_isTileAsleep[ tileIndex ] == 0 )
+		return;
+
+	int firstRow = ( tileIndex / m_numTileCols ) * TILE_SIZE;
+	int firstCol = ( tileIndex % m_numTileCols ) * TILE_SIZE;
+	int lastRow = ( firstRow + TILE_SIZE < m_numRows ) ? firstRow + TILE_SIZE : m_numRows;
+	int lastCol = ( firstCol + TILE_SIZE < m_numCols ) ? firstCol + TILE_SIZE : m_numCols;
+	for ( int row = firstRow; row < lastRow; ++row )
+	{
+		for ( int col = firstCol; col < lastCol; ++col )
+			particles.m_inverseMass[ ( row * m_numCols ) + col ] = m_inverseMassBeforeSleep[ ( row * m_numCols ) + col ];
+	}
+
+	m_isTileAsleep[ tileIndex ] = 0;
+	m_numStillUpdates[ tileIndex ] = 0;
+	--m_numSleepingTiles;
+	m_areAwakeRangesDirty = true;
+	m_areAwakeBatchesDirty = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSleep::WakeAll( ClothParticleStore& particles )
+{
+	for ( unsigned int tileIndex = 0; m_numSleepingTiles > 0 && tileIndex < m_isTileAsleep.size(); ++tileIndex )
+		WakeTile( tileIndex, particles );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSleep::WakeTileOfParticle( unsigned int particleIndex, ClothParticleStore& particles )
+{
+	if ( m_numSleepingTiles > 0 )
+		WakeTile( GetTileOfParticle( particleIndex ), particles );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSleep::WakeTilesOfRow( int row, ClothParticleStore& particles )
+{
+	int tileRow = row / TILE_SIZE;
+	for ( int tileCol = 0; m_numSleepingTiles > 0 && tileCol < m_numTileCols; ++tileCol )
+		WakeTile( ( tileRow * m_numTileCols ) + tileCol, particles );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothSleep::WakeTilesTouchingSphere( const Vector3& center, float radius, ClothParticleStore& particles )
+{
+	for ( unsigned int tileIndex = 0; m_numSleepingTiles > 0 && tileIndex < m_isTileAsleep.size(); ++tileIndex )
+	{
+		if ( m_isTileAsleep[ tileIndex ] == 0 )
+			continue;
+
+		//Distance from the center to the nearest point of the tile's bounds.
+		const Vector3& mins = m_tileMins[ tileIndex ];
+		const Vector3& maxs = m_tileMaxs[ tileIndex ];
+		float dx = fmaxf( fmaxf( mins.x - center.x, center.x - maxs.x ), 0.f );
+		float dy = fmaxf( fmaxf( mins.y - center.y, center.y - maxs.y ), 0.f );
+		float dz = fmaxf( fmaxf( mins.z - center.z, center.z - maxs.z ), 0.f );
+		if ( ( dx * dx ) + ( dy * dy ) + ( dz * dz ) <= radius * radius )
+			WakeTile( tileIndex, particles );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+const std::vector<ClothSleep::ParticleRange>& ClothSleep::GetAwakeRanges()
+{
+	if ( !m_areAwakeRangesDirty )
+		return m_awakeRanges;
+
+	m_awakeRanges.clear();
+	for ( int row = 0; row < m_numRows; ++row )
+	{
+		for ( int tileCol = 0; tileCol < m_numTileCols; ++tileCol )
+		{
+			if ( m_isTileAsleep[ ( ( row / TILE_SIZE ) * m_numTileCols ) + tileCol ] != 0 )
+				continue;
+
+			int lastCol = ( ( tileCol + 1 ) * TILE_SIZE < m_numCols ) ? ( tileCol + 1 ) * TILE_SIZE : m_numCols;
+			ParticleRange range = { static_cast<unsigned int>( ( row * m_numCols ) + ( tileCol * TILE_SIZE ) ), static_cast<unsigned int>( ( row * m_numCols ) + lastCol ) };
+			if ( !m_awakeRanges.empty() && m_awakeRanges.back().end == range.begin )
+				m_awakeRanges.back().end = range.end; //Neighboring awake tiles, or a row of them running on into the next row.
+			else
+				m_awakeRanges.push_back( range );
+		}
+	}
+	m_areAwakeRangesDirty = false;
+	return m_awakeRanges;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+std::vector<ClothConstraintBatch>& ClothSleep::GetAwakeBatches( const ClothConstraintSet& constraints )
+{
+	if ( !m_areAwakeBatchesDirty && m_awakeBatchesRevision == constraints.GetRevision() )
+		return m_awakeBatches;
+
+	//Copies keep each batch's coloring, so they solve exactly like the originals minus the frozen constraints.
+	//Resized rather than cleared, so rebuilding as tiles come and go reuses the same allocations.
+	m_awakeBatches.resize( constraints.m_batches.size(), ClothConstraintBatch( STRETCH, 0 ) );
+	for ( unsigned int batchIndex = 0; batchIndex < constraints.m_batches.size(); ++batchIndex )
+	{
+		const ClothConstraintBatch& batch = constraints.m_batches[ batchIndex ];
+		ClothConstraintBatch& awakeBatch = m_awakeBatches[ batchIndex ];
+		awakeBatch.m_type = batch.m_type;
+		awakeBatch.m_color = batch.m_color;
+		awakeBatch.m_constraints.clear();
+		awakeBatch.m_constraintIDs.clear();
+		awakeBatch.m_lambdas.clear();
+		for ( unsigned int slot = 0; slot < batch.m_constraints.size(); ++slot )
+		{
+			const ClothConstraint& constraint = batch.m_constraints[ slot ];
+			if ( IsParticleAsleep( constraint.p1 ) && IsParticleAsleep( constraint.p2 ) )
+				continue;
+
+			awakeBatch.m_constraints.push_back( constraint );
+			awakeBatch.m_constraintIDs.push_back( batch.m_constraintIDs[ slot ] );
+		}
+	}
+	m_areAwakeBatchesDirty = false;
+	m_awakeBatchesRevision = constraints.GetRevision();
+	return m_awakeBatches;
+}
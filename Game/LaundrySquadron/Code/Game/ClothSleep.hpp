@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+#include "Engine/Math/Vector3.hpp"
+#include "Game/ClothConstraints.hpp"
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+//Sleep for settled regions of a cloth grid, tracked per square tile of particles. A tile whose particles all moved less than
+//the sleep distance per step for enough Updates in a row is frozen: its particles get zero inverse mass and velocity and are
+//left out of integration, and constraints with both ends asleep drop out of the solve. Frozen particles still anchor their awake neighbors.
+class ClothSleep
+{
+public:
+	struct ParticleRange
+	{
+		unsigned int begin;
+		unsigned int end;
+	};
+
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothSleep();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void BuildForGrid( int numRows, int numCols ); //Every tile starts awake.
+	//Call after an Update's fixed steps. Tiles still for long enough fall asleep; sleeping tiles beside an awake one that moved wake up.
+	void Update( ClothParticleStore& particles, const ClothConstraintSet& constraints, ThreadPool* threadPool );
+	void WakeAll( ClothParticleStore& particles );
+	void WakeTileOfParticle( unsigned int particleIndex, ClothParticleStore& particles ); //Before changing anything about the particle.
+	void WakeTilesOfRow( int row, ClothParticleStore& particles );
+	void WakeTilesTouchingSphere( const Vector3& center, float radius, ClothParticleStore& particles );
+	bool HasSleepingTiles() const { return m_numSleepingTiles > 0; }
+	bool IsEveryTileAsleep() const { return m_numSleepingTiles > 0 && m_numSleepingTiles == m_isTileAsleep.size(); }
+	unsigned int GetNumTiles() const { return m_isTileAsleep.size(); }
+	unsigned int GetNumSleepingTiles() const { return m_numSleepingTiles; }
+	const std::vector<ParticleRange>& GetAwakeRanges(); //Contiguous runs of awake particle indices, merged across tiles and rows.
+	//Copies of the constraint batches without the constraints whose ends are both asleep, rebuilt only once a tile changes state or a constraint is removed.
+	std::vector<ClothConstraintBatch>& GetAwakeBatches( const ClothConstraintSet& constraints );
+	void SetSleepDistance( float sleepDistance ) { m_sleepDistance = sleepDistance; } //Per fixed step, so it's really a speed.
+	float GetSleepDistance() const { return m_sleepDistance; }
+	void SetNumStillUpdatesToSleep( unsigned int numUpdates ) { m_numStillUpdatesToSleep = ( numUpdates > 0 ) ? numUpdates : 1; }
+	unsigned int GetNumStillUpdatesToSleep() const { return m_numStillUpdatesToSleep; }
+
+
+private:
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const int TILE_SIZE = 8; //Particles per side. Small enough to wake locally, big enough that the bookkeeping is noise.
+	static const unsigned int TILES_PER_TASK = 16;
+	static const unsigned int DEFAULT_NUM_STILL_UPDATES_TO_SLEEP = 30; //Half a second at 60 Updates a second.
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	unsigned int GetTileOfParticle( unsigned int particleIndex ) const { return ( ( ( particleIndex / m_numCols ) / TILE_SIZE ) * m_numTileCols ) + ( ( particleIndex % m_numCols ) / TILE_SIZE ); }
+	bool IsParticleAsleep( unsigned int particleIndex ) const { return m_isTileAsleep[ GetTileOfParticle( particleIndex ) ] != 0; }
+	float MeasureTileDisplacement( unsigned int tileIndex, const ClothParticleStore& particles, const ClothConstraintSet& constraints ) const;
+	void SleepTile( unsigned int tileIndex, ClothParticleStore& particles );
+	void WakeTile( unsigned int tileIndex, ClothParticleStore& particles );
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	int m_numRows;
+	int m_numCols;
+	int m_numTileRows;
+	int m_numTileCols;
+	float m_sleepDistance;
+	unsigned int m_numStillUpdatesToSleep;
+	unsigned int m_numSleepingTiles;
+	std::vector<unsigned char> m_isTileAsleep;
+	std::vector<unsigned int> m_numStillUpdates; //Per tile: Updates in a row it moved less than the sleep distance.
+	std::vector<float> m_tileDisplacement; //Per tile: the farthest any of its particles moved over the last step. 0 while asleep.
+	std::vector<Vector3> m_tileMins; //Per tile: bounds of its particles, only kept up to date while it sleeps (when they can't move).
+	std::vector<Vector3> m_tileMaxs;
+	std::vector<unsigned int> m_tilesToWake;
+	std::vector<float> m_inverseMassBeforeSleep; //Per particle, restored when its tile wakes.
+	std::vector<ParticleRange> m_awakeRanges;
+	bool m_areAwakeRangesDirty;
+	std::vector<ClothConstraintBatch> m_awakeBatches;
+	bool m_areAwakeBatchesDirty;
+	unsigned int m_awakeBatchesRevision; //ClothConstraintSet::GetRevision when m_awakeBatches was built.
+};
@@ -0,0 +1,120 @@
+#include "Game/ClothTethers.hpp"
+#include "Game/ClothParticleStore.hpp"
+#include "Game/ClothConstraints.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include <cmath>
+#include <functional>
+#include <queue>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const unsigned int NO_ANCHOR = 0xFFFFFFFF; //Not connected to any pin, or only through removed constraints.
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothTethers::ClothTethers()
+	: m_slack( 0.f )
+	, m_isDirty( true )
+	, m_builtRevision( 0 )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothTethers::Build( const ClothParticleStore& particles, const ClothConstraintSet& constraints )
+{
+	//Dijkstra from every pin at once over the live constraints, weighted by rest distance: each particle ends up with its nearest pin
+	//and the rest distance to it. Around a tear that's the way around, and a piece torn free has no pin to reach, so no tether.
+	//Paths along the grid's edges and diagonals are never shorter than the straight line at rest, so no tether is tighter than the cloth.
+	typedef std::pair<float, unsigned int> QueueEntry;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> frontier;
+
+	const unsigned int numParticles = particles.GetNumParticles();
+	m_restDistanceToAnchor.assign( numParticles, INFINITY );
+	m_nearestAnchor.assign( numParticles, NO_ANCHOR );
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+	{
+		if ( particles.IsPinned( particleIndex ) && !particles.IsExpired( particleIndex ) )
+		{
+			m_restDistanceToAnchor[ particleIndex ] = 0.f;
+			m_nearestAnchor[ particleIndex ] = particleIndex;
+			frontier.push( QueueEntry( 0.f, particleIndex ) );
+		}
+	}
+
+	while ( !frontier.empty() )
+	{
+		QueueEntry entry = frontier.top();
+		frontier.pop();
+		unsigned int particleIndex = entry.second;
+		if ( entry.first > m_restDistanceToAnchor[ particleIndex ] )
+			continue; //Already reached by a shorter path.
+
+		for ( unsigned int adjacencyIndex = constraints.GetAdjacencyBegin( particleIndex ); adjacencyIndex < constraints.GetAdjacencyEnd( particleIndex ); ++adjacencyIndex )
+		{
+			unsigned int constraintID = constraints.GetAdjacentConstraintID( adjacencyIndex );
+			if ( constraints.IsConstraintRemoved( constraintID ) )
+				continue;
+
+			const ClothConstraint& cc = constraints.GetConstraint( constraintID );
+			unsigned int neighborIndex = ( cc.p1 == particleIndex ) ? cc.p2 : cc.p1;
+			float restDistance = entry.first + cc.restDistance;
+			if ( restDistance < m_restDistanceToAnchor[ neighborIndex ] )
+			{
+				m_restDistanceToAnchor[ neighborIndex ] = restDistance;
+				m_nearestAnchor[ neighborIndex ] = m_nearestAnchor[ particleIndex ];
+				frontier.push( QueueEntry( restDistance, neighborIndex ) );
+			}
+		}
+	}
+
+	m_particleIndices.clear();
+	m_anchorIndices.clear();
+	m_maxDistances.clear();
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; ++particleIndex )
+	{
+		if ( m_nearestAnchor[ particleIndex ] == NO_ANCHOR || m_nearestAnchor[ particleIndex ] == particleIndex )
+			continue;
+
+		m_particleIndices.push_back( particleIndex );
+		m_anchorIndices.push_back( m_nearestAnchor[ particleIndex ] );
+		m_maxDistances.push_back( m_restDistanceToAnchor[ particleIndex ] );
+	}
+
+	m_isDirty = false;
+	m_builtRevision = constraints.GetRevision();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothTethers::Solve( ClothParticleStore& particles, const ClothConstraintSet& constraints, ThreadPool* threadPool )
+{
+	if ( m_isDirty || m_builtRevision != constraints.GetRevision() )
+		Build( particles, constraints );
+
+	const float reachScale = 1.f + m_slack;
+	ThreadPool::ParallelFor( threadPool, m_particleIndices.size(), TETHERS_PER_TASK, [ this, &particles, reachScale ]( unsigned int begin, unsigned int end )
+	{
+		for ( unsigned int tetherIndex = begin; tetherIndex < end; tetherIndex++ )
+		{
+			unsigned int particleIndex = m_particleIndices[ tetherIndex ];
+			if ( particles.m_inverseMass[ particleIndex ] == 0.f ) //Asleep, or pinned since the last build.
+				continue;
+
+			unsigned int anchorIndex = m_anchorIndices[ tetherIndex ];
+			float dx = particles.m_positionX[ particleIndex ] - particles.m_positionX[ anchorIndex ];
+			float dy = particles.m_positionY[ particleIndex ] - particles.m_positionY[ anchorIndex ];
+			float dz = particles.m_positionZ[ particleIndex ] - particles.m_positionZ[ anchorIndex ];
+			float maxDistance = m_maxDistances[ tetherIndex ] * reachScale;
+			float distanceSquared = ( dx * dx ) + ( dy * dy ) + ( dz * dz );
+			if ( distanceSquared <= maxDistance * maxDistance )
+				continue;
+
+			//The anchor is pinned, so only the particle moves: straight back onto the sphere it may roam.
+			float scale = maxDistance / sqrtf( distanceSquared );
+			particles.m_positionX[ particleIndex ] = particles.m_positionX[ anchorIndex ] + ( dx * scale );
+			particles.m_positionY[ particleIndex ] = particles.m_positionY[ anchorIndex ] + ( dy * scale );
+			particles.m_positionZ[ particleIndex ] = particles.m_positionZ[ anchorIndex ] + ( dz * scale );
+		}
+	} );
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+class ClothParticleStore;
+class ClothConstraintSet;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+//Long-range attachments: every free particle is tethered to its nearest pinned particle, measured along the live constraints at
+//rest, and is pulled back inside that distance whenever it strays beyond it. A pin's hold reaches the whole cloth in one pass
+//instead of one constraint per iteration, so tall cloths stop over-stretching without raising the iteration count.
+//Tethers are unilateral: they never push a particle toward its anchor, so folds and slack are left to the other constraints.
+class ClothTethers
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothTethers();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	//Call whenever particles are pinned, unpinned or expire. Constraint removals are noticed through the set's revision.
+	void MarkDirty() { m_isDirty = true; }
+	//Rebuilds the tethers if needed, then projects every free particle that's out of reach. One task per range of tethers;
+	//each particle has at most one, so they never contend.
+	void Solve( ClothParticleStore& particles, const ClothConstraintSet& constraints, ThreadPool* threadPool );
+	void SetSlack( float slack ) { m_slack = slack; } //Fraction of the rest distance a particle may stray beyond. 0 is taut.
+	float GetSlack() const { return m_slack; }
+	unsigned int GetNumTethers() const { return m_particleIndices.size(); }
+
+
+private:
+	//CONSTANTS//////////////////////////////////////////////////////////////////////////
+	static const unsigned int TETHERS_PER_TASK = 1024;
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void Build( const ClothParticleStore& particles, const ClothConstraintSet& constraints );
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	float m_slack;
+	bool m_isDirty;
+	unsigned int m_builtRevision; //ClothConstraintSet::GetRevision when the tethers were built.
+	std::vector<unsigned int> m_particleIndices; //Parallel arrays, one entry per tether.
+	std::vector<unsigned int> m_anchorIndices;
+	std::vector<float> m_maxDistances; //Rest distance from the anchor along the constraints, before slack.
+	std::vector<float> m_restDistanceToAnchor; //Per particle, scratch for Build.
+	std::vector<unsigned int> m_nearestAnchor; //Per particle, scratch for Build.
+};
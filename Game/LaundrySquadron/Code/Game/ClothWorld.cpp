@@ -0,0 +1,187 @@
+#include "Game/ClothWorld.hpp"
+#include "Game/Cloth.hpp"
+#include "Game/ClothLod.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include "Engine/Time/Time.hpp"
+#include <algorithm>
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothWorld::ClothWorld( ThreadPool* threadPool )
+	: m_threadPool( threadPool )
+	, m_isUpdateOrderDirty( false )
+	, m_hasViewpoint( false )
+	, m_pixelsPerUnitAtUnitDistance( 0.f )
+{
+	GatherStats();
+	m_stats.m_updateMilliseconds = 0.0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothWorld::~ClothWorld()
+{
+	RemoveAllCloths();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Cloth* ClothWorld::AddCloth( Cloth* cloth )
+{
+	m_cloths.push_back( cloth );
+	m_clothLods.push_back( nullptr );
+	m_isUpdateOrderDirty = true;
+	return cloth;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ClothLod* ClothWorld::AddClothLod( ClothLod* clothLod )
+{
+	m_cloths.push_back( clothLod->GetActiveCloth() );
+	m_clothLods.push_back( clothLod );
+	m_isUpdateOrderDirty = true;
+	return clothLod;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothWorld::RemoveCloth( Cloth* cloth )
+{
+	auto clothIter = std::find( m_cloths.begin(), m_cloths.end(), cloth );
+	if ( clothIter == m_cloths.end() )
+		return;
+
+	unsigned int clothIndex = clothIter - m_cloths.begin();
+	ClothLod* clothLod = m_clothLods[ clothIndex ];
+	m_cloths.erase( clothIter );
+	m_clothLods.erase( m_clothLods.begin() + clothIndex );
+	m_isUpdateOrderDirty = true;
+	if ( clothLod != nullptr )
+		delete clothLod; //Owns cloth.
+	else
+		delete cloth;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothWorld::RemoveAllCloths()
+{
+	for ( unsigned int clothIndex = 0; clothIndex < m_cloths.size(); ++clothIndex )
+	{
+		if ( m_clothLods[ clothIndex ] != nullptr )
+			delete m_clothLods[ clothIndex ];
+		else
+			delete m_cloths[ clothIndex ];
+	}
+	m_cloths.clear();
+	m_clothLods.clear();
+	m_updateOrder.clear();
+	m_isUpdateOrderDirty = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothWorld::SortUpdateOrder()
+{
+	m_updateOrder = m_cloths;
+	std::stable_sort( m_updateOrder.begin(), m_updateOrder.end(), []( const Cloth* lhs, const Cloth* rhs )
+	{
+		return lhs->GetNumParticles() > rhs->GetNumParticles();
+	} );
+	m_isUpdateOrderDirty = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothWorld::SetViewpoint( const Vector3& viewPosition, float pixelsPerUnitAtUnitDistance )
+{
+	m_hasViewpoint = true;
+	m_viewPosition = viewPosition;
+	m_pixelsPerUnitAtUnitDistance = pixelsPerUnitAtUnitDistance;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothWorld::UpdateLevelsOfDetail()
+{
+	if ( !m_hasViewpoint )
+		return;
+
+	//Serial: a check is a couple of distances per cloth, and a switch only touches the two levels involved.
+	for ( unsigned int clothIndex = 0; clothIndex < m_cloths.size(); ++clothIndex )
+	{
+		ClothLod* clothLod = m_clothLods[ clothIndex ];
+		if ( clothLod != nullptr && clothLod->UpdateLevel( m_viewPosition, m_pixelsPerUnitAtUnitDistance ) )
+		{
+			m_cloths[ clothIndex ] = clothLod->GetActiveCloth();
+			m_isUpdateOrderDirty = true; //Its particle count changed, and m_updateOrder still points at the old level.
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothWorld::Update( float deltaSeconds )
+{
+	double startSeconds = GetCurrentTimeSeconds();
+	UpdateLevelsOfDetail();
+	if ( m_isUpdateOrderDirty )
+		SortUpdateOrder();
+
+	if ( m_threadPool == nullptr || m_updateOrder.size() < m_threadPool->GetNumThreads() )
+	{
+		//Too few cloths to keep every thread busy: go wide inside each cloth instead.
+		for ( Cloth* cloth : m_updateOrder )
+		{
+			cloth->SetThreadPool( m_threadPool );
+			cloth->Update( deltaSeconds );
+		}
+	}
+	else
+	{
+		//One task per cloth. Cloths don't share any state, so no cloth needs to wait on another.
+		for ( Cloth* cloth : m_updateOrder )
+			cloth->SetThreadPool( nullptr );
+
+		m_threadPool->ParallelFor( m_updateOrder.size(), 1, [ this, deltaSeconds ]( unsigned int begin, unsigned int end )
+		{
+			for ( unsigned int clothIndex = begin; clothIndex < end; ++clothIndex )
+				m_updateOrder[ clothIndex ]->Update( deltaSeconds );
+		} );
+	}
+
+	GatherStats();
+	m_stats.m_updateMilliseconds = ( GetCurrentTimeSeconds() - startSeconds ) * 1000.0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothWorld::GatherStats()
+{
+	m_stats.m_numCloths = m_cloths.size();
+	m_stats.m_numDeadCloths = 0;
+	m_stats.m_numParticles = 0;
+	m_stats.m_numConstraints = 0;
+	m_stats.m_numTornConstraints = 0;
+	m_stats.m_numFixedSteps = 0;
+	m_stats.m_numReducedCloths = 0;
+	for ( const ClothLod* clothLod : m_clothLods )
+		m_stats.m_numReducedCloths += ( clothLod != nullptr && clothLod->GetActiveLevel() > 0 ) ? 1 : 0;
+	for ( const Cloth* cloth : m_cloths )
+	{
+		m_stats.m_numDeadCloths += cloth->IsDead() ? 1 : 0;
+		m_stats.m_numParticles += cloth->GetNumParticles();
+		m_stats.m_numConstraints += cloth->GetNumConstraints();
+		m_stats.m_numTornConstraints += cloth->GetNumTornConstraints();
+		m_stats.m_numFixedSteps += cloth->GetNumFixedStepsLastUpdate();
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClothWorld::Render( bool showCloth /*= true*/, bool showConstraints /*= false*/, bool showParticles /*= false*/ ) const
+{
+	for ( Cloth* cloth : m_cloths )
+		cloth->Render( showCloth, showConstraints, showParticles );
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include "Engine/Math/Vector3.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Cloth;
+class ClothLod;
+class ThreadPool;
+
+
+//-----------------------------------------------------------------------------
+struct ClothWorldStats //Totals over every cloth, as of the last ClothWorld::Update.
+{
+	unsigned int m_numCloths;
+	unsigned int m_numDeadCloths;
+	unsigned int m_numParticles;
+	unsigned int m_numConstraints;
+	unsigned int m_numTornConstraints;
+	unsigned int m_numFixedSteps; //Summed over cloths, so 8 cloths that each took 4 steps count 32.
+	unsigned int m_numReducedCloths; //Level-of-detail cloths running below their finest level.
+	double m_updateMilliseconds; //Wall time of the whole Update.
+};
+
+
+//-----------------------------------------------------------------------------
+//Owns a set of independent cloths and steps them together. With at least as many cloths as threads, each cloth is one task
+//(claimed dynamically, biggest first, and run single-threaded inside it); with fewer, cloths run one after another and each
+//spreads its own batches across the pool instead. Either way a cloth is only ever touched by one thread at a time.
+//Cloths added through AddClothLod switch resolution with distance from the viewpoint, before each Update; GetCloth returns
+//whichever level is active, so a pointer to one of them only stays valid until the next Update.
+class ClothWorld
+{
+public:
+	//CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+	ClothWorld( ThreadPool* threadPool );
+	~ClothWorld();
+
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	Cloth* AddCloth( Cloth* cloth ); //World takes ownership. Returns cloth, for chaining.
+	ClothLod* AddClothLod( ClothLod* clothLod ); //World takes ownership. Returns clothLod, for chaining.
+	void RemoveCloth( Cloth* cloth ); //Deletes it, along with its other levels if it's the active level of a ClothLod.
+	void RemoveAllCloths();
+	void SetViewpoint( const Vector3& viewPosition, float pixelsPerUnitAtUnitDistance ); //Call before Update. Until then every ClothLod stays at its finest.
+	void Update( float deltaSeconds );
+	void Render( bool showCloth = true, bool showConstraints = false, bool showParticles = false ) const;
+	unsigned int GetNumCloths() const { return m_cloths.size(); }
+	Cloth* GetCloth( unsigned int clothIndex ) const { return m_cloths[ clothIndex ]; }
+	const ClothWorldStats& GetStats() const { return m_stats; }
+
+
+private:
+	//FUNCTIONS//////////////////////////////////////////////////////////////////////////
+	void SortUpdateOrder();
+	void UpdateLevelsOfDetail();
+	void GatherStats();
+
+	//MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+	ThreadPool* m_threadPool;
+	std::vector<Cloth*> m_cloths; //In the order added.
+	std::vector<ClothLod*> m_clothLods; //Parallel to m_cloths: the ClothLod whose active level that cloth is, else nullptr.
+	std::vector<Cloth*> m_updateOrder; //Most particles first, so the longest tasks start early instead of trailing at the end.
+	bool m_isUpdateOrderDirty;
+	bool m_hasViewpoint;
+	Vector3 m_viewPosition;
+	float m_pixelsPerUnitAtUnitDistance;
+	ClothWorldStats m_stats;
+};
@@ -10,6 +10,7 @@
 #include "Engine/Audio/Audio.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Input/Console.hpp"
+#include "Engine/Core/ThreadPool.hpp"
 #include "Game/TheApp.hpp"
 #include "Game/TheGame.hpp"
 
@@ -197,6 +198,7 @@ void Initialize(HINSTANCE applicationInstanceHandle)
 	AudioSystem::instance = new AudioSystem();
 	InputSystem::instance = new InputSystem(g_hWnd);
 	Console::instance = new Console();
+	ThreadPool::instance = new ThreadPool();
 	TheApp::instance = new TheApp(VIEW_RIGHT, VIEW_TOP);
 	TheGame::instance = new TheGame();
 }
@@ -209,6 +211,8 @@ void Shutdown()
 	TheGame::instance = nullptr;
 	delete TheApp::instance;
 	TheApp::instance = nullptr;
+	delete ThreadPool::instance;
+	ThreadPool::instance = nullptr;
 	delete Console::instance;
 	Console::instance = nullptr;
 	delete InputSystem::instance;
@@ -43,12 +43,12 @@ void Particle::Render()
 
 
 //--------------------------------------------------------------------------------------------------------------
-void Particle::StepAndAge( float deltaSeconds )
+void Particle::StepAndAge( float deltaSeconds, const Vector3& sharedForce /*= Vector3::ZERO*/ )
 {
 	//Commented out because the expire-after-x-seconds logic is not needed for the cloth simulation.
 
 //	m_state->StepWithForwardEuler( m_mass, deltaSeconds );
-	m_state->StepWithVerlet( m_mass, deltaSeconds );
+	m_state->StepWithVerlet( m_mass, deltaSeconds, sharedForce );
 //	m_secondsToLive -= deltaSeconds;
 }
 
@@ -163,16 +163,15 @@ void LinearDynamicsState::StepWithForwardEuler( float mass, float deltaSeconds )
 	m_velocity += dState.m_velocity * deltaSeconds; //v := v + (accel * dt)
 }
 
-void LinearDynamicsState::StepWithVerlet( float mass, float deltaSeconds )
+void LinearDynamicsState::StepWithVerlet( float mass, float deltaSeconds, const Vector3& sharedForce /*= Vector3::ZERO*/ )
 {
 	//https://en.wikipedia.org/wiki/Verlet_integration#Velocity_Verlet - to do away with the x_(t-1) at t=0 problem.
-	static Vector3 prevAccel = 0.f;
+	//Previous acceleration is per-state, so each particle's result no longer depends on which particles stepped before it.
+	Vector3 acceleration = ( CalcNetForceForMass( mass ) + sharedForce ) * ( 1.f / mass );
 
-	LinearDynamicsState dState = dStateForMass( mass );
-
-	m_position += ( m_velocity*deltaSeconds ) + ( dState.m_velocity*.5f*deltaSeconds*deltaSeconds ); //x := x + v*dt + .5*a*dt*dt.
-	m_velocity += ( prevAccel + dState.m_velocity )*.5f*deltaSeconds; //v := v + .5*(a + a_next)*dt.
-	prevAccel = dState.m_velocity;
+	m_position += ( m_velocity*deltaSeconds ) + ( acceleration*.5f*deltaSeconds*deltaSeconds ); //x := x + v*dt + .5*a*dt*dt.
+	m_velocity += ( m_previousAcceleration + acceleration )*.5f*deltaSeconds; //v := v + .5*(a + a_next)*dt.
+	m_previousAcceleration = acceleration;
 }
 
 
@@ -259,8 +258,15 @@ Vector3 WormholeForce::CalcDirectionForState( const LinearDynamicsState * lds )
 //--------------------------------------------------------------------------------------------------------------
 Vector3 WormholeForce::CalcForceForStateAndMass( const LinearDynamicsState* lds, float /*mass*/ ) const
 {
-	Vector3 windVector = CalcDirectionForState( lds ) * CalcMagnitudeForState( lds );
-	Vector3 undampedWindForce = lds->GetVelocity() - windVector;
+	return CalcForceAt( lds->GetPosition(), lds->GetVelocity() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector3 WormholeForce::CalcForceAt( const Vector3& position, const Vector3& velocity ) const
+{
+	Vector3 windVector = ( m_center - position ) * ( m_magnitude * position.CalculateMagnitude() ); //Same wind as CalcDirectionForState * CalcMagnitudeForState.
+	Vector3 undampedWindForce = velocity - windVector;
 
 	return undampedWindForce * -m_dampedness;
 }
@@ -320,9 +326,37 @@ void ParticleSystem::UpdateParticles( float deltaSeconds )
 //--------------------------------------------------------------------------------------------------------------
 void ParticleSystem::StepAndAgeParticles( float deltaSeconds )
 {
-	for ( unsigned int particleIndex = 0; particleIndex < m_unexpiredParticles.size(); particleIndex++ )
+	//Gather into SoA so the shared fields run once over every particle, then step each with its share.
+	unsigned int numParticles = m_unexpiredParticles.size();
+	m_stepScratch.resize( numParticles * 9 );
+	float* positionX = m_stepScratch.data();
+	float* positionY = positionX + numParticles;
+	float* positionZ = positionY + numParticles;
+	float* velocityX = positionZ + numParticles;
+	float* velocityY = velocityX + numParticles;
+	float* velocityZ = velocityY + numParticles;
+	float* forceX = velocityZ + numParticles;
+	float* forceY = forceX + numParticles;
+	float* forceZ = forceY + numParticles;
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; particleIndex++ )
 	{
-		m_unexpiredParticles[ particleIndex ]->StepAndAge( deltaSeconds );
+		const LinearDynamicsState* state = m_unexpiredParticles[ particleIndex ]->m_state;
+		Vector3 position = state->GetPosition();
+		Vector3 velocity = state->GetVelocity();
+		positionX[ particleIndex ] = position.x;
+		positionY[ particleIndex ] = position.y;
+		positionZ[ particleIndex ] = position.z;
+		velocityX[ particleIndex ] = velocity.x;
+		velocityY[ particleIndex ] = velocity.y;
+		velocityZ[ particleIndex ] = velocity.z;
+	}
+
+	//Every particle is a copy of m_particleToEmit, so they all share its mass.
+	m_forceFields.CalcNetForces( 0, numParticles, m_particleToEmit.GetMass(), positionX, positionY, positionZ, velocityX, velocityY, velocityZ, forceX, forceY, forceZ );
+
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; particleIndex++ )
+	{
+		m_unexpiredParticles[ particleIndex ]->StepAndAge( deltaSeconds, Vector3( forceX[ particleIndex ], forceY[ particleIndex ], forceZ[ particleIndex ] ) );
 	}
 }
 
@@ -365,8 +399,7 @@ void ParticleSystem::EmitParticles( float deltaSeconds )
 			muzzleVelocity.z = m_muzzleSpeed
 				* MathUtils::CosDegrees( ( spanDegreesDownFromWorldUp		* MathUtils::GetRandomFromZeroTo(1.0f)) + m_minDegreesDownFromWorldUp ); //Embeds assumption z is world-up? Would it work if using y-up, just rotated by 90deg?
 
-			newParticle->SetParticleState( new LinearDynamicsState( newParticlePosition, muzzleVelocity ) );
-			newParticle->CloneForcesFromParticle( &m_particleToEmit );
+			newParticle->SetParticleState( new LinearDynamicsState( newParticlePosition, muzzleVelocity ) ); //Forces stay in m_forceFields, not copied per particle.
 			m_unexpiredParticles.push_back( newParticle );
 		}
 
@@ -379,7 +412,25 @@ void ParticleSystem::EmitParticles( float deltaSeconds )
 //--------------------------------------------------------------------------------------------------------------
 Vector3 DebrisForce::CalcForceForStateAndMass( const LinearDynamicsState * lds, float mass ) const
 {
-	return CalcDirectionForState( lds ) * CalcMagnitudeForState( lds ) * mass;
+	return CalcForceAt( lds->GetPosition(), lds->GetVelocity(), mass );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector3 DebrisForce::CalcForceAt( const Vector3& position, const Vector3& velocity, float mass ) const
+{
+	//Inlines CalcDirectionForState and CalcMagnitudeForState, so typed batches never go through the vtable.
+	float upComponentForPosition = MathUtils::Dot( position, Vector3::UP );
+	float upComponentForVelocity = MathUtils::Dot( velocity, Vector3::UP );
+	Vector3 direction = ( upComponentForPosition < m_groundHeight ) ? Vector3::UP : -Vector3::UP;
+
+	float magnitude = upComponentForPosition;
+	if ( upComponentForPosition < m_groundHeight )
+		magnitude *= -10.f;
+	else if ( upComponentForPosition > m_groundHeight && upComponentForVelocity < 0 )
+		magnitude *= .65f;
+
+	return direction * magnitude * mass;
 }
 
 
@@ -409,3 +460,139 @@ Vector3 DebrisForce::CalcDirectionForState( const LinearDynamicsState * lds ) co
 	else 
 		return -Vector3::UP;
 }
+
+
+//--------------------------------------------------------------------------------------------------------------
+ForceFieldSet::ForceFieldSet()
+{
+	UpdateLinearTerms();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ForceFieldSet::~ForceFieldSet()
+{
+	for ( Force* force : m_otherForces )
+		delete force;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ForceFieldSet::AddForce( Force* force )
+{
+	//Sorted once here, by type, so evaluating never needs to ask again.
+	if ( GravityForce* gravityForce = dynamic_cast<GravityForce*>( force ) )
+		m_gravityForces.push_back( *gravityForce );
+	else if ( ConstantWindForce* windForce = dynamic_cast<ConstantWindForce*>( force ) )
+		m_windForces.push_back( *windForce );
+	else if ( SpringForce* springForce = dynamic_cast<SpringForce*>( force ) )
+		m_springForces.push_back( *springForce );
+	else if ( WormholeForce* wormholeForce = dynamic_cast<WormholeForce*>( force ) )
+		m_wormholeForces.push_back( *wormholeForce );
+	else if ( DebrisForce* debrisForce = dynamic_cast<DebrisForce*>( force ) )
+		m_debrisForces.push_back( *debrisForce );
+	else
+	{
+		m_otherForces.push_back( force );
+		return;
+	}
+
+	delete force; //Copied into its batch.
+	UpdateLinearTerms();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ForceFieldSet::Clear( bool keepGravity /*= true*/ )
+{
+	if ( !keepGravity )
+		m_gravityForces.clear();
+	m_windForces.clear();
+	m_springForces.clear();
+	m_wormholeForces.clear();
+	m_debrisForces.clear();
+	for ( Force* force : m_otherForces )
+		delete force;
+	m_otherForces.clear();
+	UpdateLinearTerms();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ForceFieldSet::GetNumForces() const
+{
+	return m_gravityForces.size() + m_windForces.size() + m_springForces.size() + m_wormholeForces.size() + m_debrisForces.size() + m_otherForces.size();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ForceFieldSet::UpdateLinearTerms()
+{
+	m_acceleration = Vector3::ZERO;
+	m_constantForce = Vector3::ZERO;
+	m_damping = 0.f;
+	m_stiffness = 0.f;
+	for ( const GravityForce& gravityForce : m_gravityForces ) // m*g
+		m_acceleration += gravityForce.GetDirection() * gravityForce.GetMagnitude();
+	for ( const ConstantWindForce& windForce : m_windForces ) // -c*(v - w) == c*w - c*v
+	{
+		m_constantForce += windForce.GetDirection() * ( windForce.GetMagnitude() * windForce.m_dampedness );
+		m_damping += windForce.m_dampedness;
+	}
+	for ( const SpringForce& springForce : m_springForces ) // -c*v - k*x
+	{
+		m_damping += springForce.m_dampedness;
+		m_stiffness += springForce.m_stiffness;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ForceFieldSet::CalcNetForces( unsigned int begin, unsigned int end, float mass,
+								   const float* positionX, const float* positionY, const float* positionZ,
+								   const float* velocityX, const float* velocityY, const float* velocityZ,
+								   float* out_forceX, float* out_forceY, float* out_forceZ ) const
+{
+	//Linear fields first: one straight pass over the arrays, the same work however many of them there are.
+	Vector3 uniformForce = ( m_acceleration * mass ) + m_constantForce;
+	for ( unsigned int index = begin; index < end; index++ )
+	{
+		out_forceX[ index ] = uniformForce.x - ( m_damping * velocityX[ index ] ) - ( m_stiffness * positionX[ index ] );
+		out_forceY[ index ] = uniformForce.y - ( m_damping * velocityY[ index ] ) - ( m_stiffness * positionY[ index ] );
+		out_forceZ[ index ] = uniformForce.z - ( m_damping * velocityZ[ index ] ) - ( m_stiffness * positionZ[ index ] );
+	}
+
+	for ( const WormholeForce& wormholeForce : m_wormholeForces )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			Vector3 force = wormholeForce.CalcForceAt( Vector3( positionX[ index ], positionY[ index ], positionZ[ index ] ), Vector3( velocityX[ index ], velocityY[ index ], velocityZ[ index ] ) );
+			out_forceX[ index ] += force.x;
+			out_forceY[ index ] += force.y;
+			out_forceZ[ index ] += force.z;
+		}
+	}
+
+	for ( const DebrisForce& debrisForce : m_debrisForces )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			Vector3 force = debrisForce.CalcForceAt( Vector3( positionX[ index ], positionY[ index ], positionZ[ index ] ), Vector3( velocityX[ index ], velocityY[ index ], velocityZ[ index ] ), mass );
+			out_forceX[ index ] += force.x;
+			out_forceY[ index ] += force.y;
+			out_forceZ[ index ] += force.z;
+		}
+	}
+
+	for ( const Force* force : m_otherForces )
+	{
+		for ( unsigned int index = begin; index < end; index++ )
+		{
+			LinearDynamicsState particleState( Vector3( positionX[ index ], positionY[ index ], positionZ[ index ] ), Vector3( velocityX[ index ], velocityY[ index ], velocityZ[ index ] ) );
+			Vector3 otherForce = force->CalcForceForStateAndMass( &particleState, mass );
+			out_forceX[ index ] += otherForce.x;
+			out_forceY[ index ] += otherForce.y;
+			out_forceZ[ index ] += otherForce.z;
+		}
+	}
+}
@@ -15,6 +15,11 @@
 #include "Engine/Math/Noise.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Game/Physics.hpp"
+#include "Game/Cloth.hpp"
+#include "Game/ClothWorld.hpp"
+#include "Game/ClothLod.hpp"
+#include "Game/ClothHistory.hpp"
+#include "Engine/Core/ThreadPool.hpp"
 
 #define WIN32_LEAN_AND_MEAN
 #include<Windows.h>
@@ -22,6 +27,10 @@
 
 TheGame* TheGame::instance = nullptr;
 const Vector3 TheGame::s_clothStartingPosition = Vector3(140.f, 20.f, 100.f);
+static const unsigned int CLOTH_HISTORY_LENGTH = 600; //Ten seconds at 60 frames a second, about 1.5KB a frame for the 10x10 cloth.
+static const float MAX_GUST_SPEED = 20.f; //m/s, a strong gale.
+static const float CAMERA_FOV_Y_DEGREES = 50.f;
+static const float VIEWPORT_HEIGHT_PIXELS = 900.f; //Matches the ortho view the HUD is laid out in.
 
 //-----------------------------------------------------------------------------------
 CONSOLE_COMMAND(twah)
@@ -34,10 +43,340 @@ CONSOLE_COMMAND(twah)
 CONSOLE_COMMAND(resetCloth)
 {
 	UNUSED(args);
-	delete TheGame::instance->m_cloth;
-	TheGame::instance->m_cloth = new Cloth(TheGame::instance->s_clothStartingPosition, PARTICLE_AABB3, 1.f, .01f, 10, 10, 5, 1.f, sqrt(2.f), 2.f);
+	//Restoring the snapshot taken at startup is a copy into the cloth's existing arrays, where rebuilding it reallocated everything.
+	Cloth* cloth = TheGame::instance->m_cloth;
+	cloth->RestoreSnapshot(TheGame::instance->m_clothStartSnapshot);
+	TheGame::instance->ResetClothGameState();
+	TheGame::instance->m_clothHistory->Clear(); //So clothRewind can't reach back past the reset.
+	cloth->SetWindVelocity(Vector3::ZERO); //Calm the last gust too.
 	AudioSystem::instance->PlaySound(TheGame::instance->m_startSFX);
-	TheGame::instance->m_gameOver = false;
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothSimd)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	if (args.HasArgs(1))
+	{
+		std::string levelName = args.GetStringArgument(0);
+		for (int level = 0; level < NUM_CLOTH_SIMD_LEVELS; ++level)
+		{
+			if (levelName == GetClothSimdLevelName((ClothSimdLevel)level))
+			{
+				cloth->SetSimdLevel((ClothSimdLevel)level);
+			}
+		}
+	}
+	else if (!args.HasArgs(0))
+	{
+		Console::instance->PrintLine("clothSimd <scalar | sse | avx2>", RGBA::GRAY);
+		return;
+	}
+	Console::instance->PrintLine(Stringf("Cloth constraint kernel: %s (best supported: %s)", GetClothSimdLevelName(cloth->GetSimdLevel()), GetClothSimdLevelName(GetBestSupportedClothSimdLevel())), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothSolver)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	const char* solverNames[NUM_CLOTH_SOLVER_TYPES] = { "pbd", "xpbd", "jacobi", "implicit" };
+	int solverType = NUM_CLOTH_SOLVER_TYPES;
+	if (args.HasArgs(1) || args.HasArgs(2) || args.HasArgs(3) || args.HasArgs(4))
+	{
+		std::string solverName = args.GetStringArgument(0);
+		for (solverType = 0; solverType < NUM_CLOTH_SOLVER_TYPES; ++solverType)
+		{
+			if (solverName == solverNames[solverType])
+			{
+				break;
+			}
+		}
+	}
+
+	bool areArgsValid = args.HasArgs(1) || args.HasArgs(2); //Every mode takes its name and optionally its iteration count.
+	switch (solverType)
+	{
+	case CLOTH_SOLVER_XPBD:		areArgsValid = areArgsValid || args.HasArgs(4); break; //Plus shear and bend compliance.
+	case CLOTH_SOLVER_JACOBI:	areArgsValid = areArgsValid || args.HasArgs(3); break; //Plus chebyshev rho.
+	case CLOTH_SOLVER_IMPLICIT:	areArgsValid = areArgsValid || args.HasArgs(3); break; //Plus stretch stiffness.
+	case CLOTH_SOLVER_PBD:		break;
+	default:					areArgsValid = false; break; //No such solver.
+	}
+	if (!areArgsValid)
+	{
+		Console::instance->PrintLine("clothSolver pbd [iterations]", RGBA::GRAY);
+		Console::instance->PrintLine("clothSolver xpbd [substeps] [shearCompliance bendCompliance]", RGBA::GRAY);
+		Console::instance->PrintLine("clothSolver jacobi [iterations] [chebyshevRho]", RGBA::GRAY);
+		Console::instance->PrintLine("clothSolver implicit [maxIterations] [stretchStiffness]", RGBA::GRAY);
+		return;
+	}
+
+	cloth->SetSolverType((ClothSolverType)solverType);
+	if (args.HasArgs(2) || args.HasArgs(3) || args.HasArgs(4))
+	{
+		if (solverType == CLOTH_SOLVER_XPBD)
+		{
+			cloth->SetNumSubsteps(args.GetIntArgument(1));
+		}
+		else if (solverType == CLOTH_SOLVER_IMPLICIT)
+		{
+			cloth->SetImplicitMaxIterations(args.GetIntArgument(1));
+		}
+		else
+		{
+			cloth->SetNumSolverIterations(args.GetIntArgument(1));
+		}
+	}
+	if (args.HasArgs(3) && solverType == CLOTH_SOLVER_JACOBI)
+	{
+		cloth->SetChebyshevSpectralRadius(std::stof(args.GetStringArgument(2)));
+	}
+	if (args.HasArgs(3) && solverType == CLOTH_SOLVER_IMPLICIT)
+	{
+		cloth->SetImplicitStiffness(STRETCH, std::stof(args.GetStringArgument(2)));
+	}
+	if (args.HasArgs(4) && solverType == CLOTH_SOLVER_XPBD)
+	{
+		cloth->SetCompliance(SHEAR, std::stof(args.GetStringArgument(2)));
+		cloth->SetCompliance(BEND, std::stof(args.GetStringArgument(3)));
+	}
+	Console::instance->PrintLine(Stringf("Cloth solver: %s, %u iterations, %u substeps, chebyshev rho %.2f", solverNames[cloth->GetSolverType()], cloth->GetNumSolverIterations(), cloth->GetNumSubsteps(), cloth->GetChebyshevSpectralRadius()), RGBA::WHITE);
+	if (cloth->GetSolverType() == CLOTH_SOLVER_IMPLICIT)
+	{
+		Console::instance->PrintLine(Stringf("Implicit: up to %u CG iterations, stretch %g N/m, last relative residual %.2g", cloth->GetImplicitMaxIterations(), cloth->GetImplicitStiffness(STRETCH), cloth->GetLastImplicitRelativeResidual()), RGBA::WHITE);
+	}
+	Console::instance->PrintLine(Stringf("Last update: residual %g, %.3f ms solving", cloth->GetLastSolveResidual(), cloth->GetLastSolveMilliseconds()), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothConvergence)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	if (args.HasArgs(1) || args.HasArgs(2))
+	{
+		cloth->SetSolverTolerance(std::stof(args.GetStringArgument(0)));
+	}
+	else
+	{
+		Console::instance->PrintLine("clothConvergence [tolerance] [numUpdatesToList]", RGBA::GRAY);
+	}
+
+	unsigned int numRecords = cloth->GetNumSolveRecords();
+	unsigned int numSteps = 0;
+	unsigned int numIterations = 0;
+	double milliseconds = 0.0;
+	double maxResidual = 0.0;
+	for (unsigned int updatesAgo = 0; updatesAgo < numRecords; ++updatesAgo)
+	{
+		const ClothSolveRecord& record = cloth->GetSolveRecord(updatesAgo);
+		numSteps += record.m_numFixedSteps;
+		numIterations += record.m_numIterations;
+		milliseconds += record.m_milliseconds;
+		maxResidual = (record.m_residual > maxResidual) ? record.m_residual : maxResidual;
+	}
+	float iterationsPerStep = (numSteps > 0) ? (float)numIterations / (float)numSteps : 0.f;
+	double millisecondsPerUpdate = (numRecords > 0) ? milliseconds / numRecords : 0.0;
+	Console::instance->PrintLine(Stringf("Tolerance %g, cap %u iterations", cloth->GetSolverTolerance(), cloth->GetNumSolverIterations()), RGBA::WHITE);
+	Console::instance->PrintLine(Stringf("Last %u updates: %.2f iterations/step, %.3f ms/update solving, max residual %g", numRecords, iterationsPerStep, millisecondsPerUpdate, maxResidual), RGBA::WHITE);
+
+	if (args.HasArgs(2))
+	{
+		unsigned int numToList = (unsigned int)args.GetIntArgument(1);
+		for (unsigned int updatesAgo = 0; updatesAgo < numToList && updatesAgo < numRecords; ++updatesAgo)
+		{
+			const ClothSolveRecord& record = cloth->GetSolveRecord(updatesAgo);
+			Console::instance->PrintLine(Stringf("-%u: %u steps, %u iterations, residual %g, %.3f ms", updatesAgo, record.m_numFixedSteps, record.m_numIterations, record.m_residual, record.m_milliseconds), RGBA::WHITE);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothHierarchy)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	if (!args.HasArgs(0) && !args.HasArgs(1) && !args.HasArgs(2))
+	{
+		Console::instance->PrintLine("clothHierarchy [on | off] [iterationsPerLevel]", RGBA::GRAY);
+		return;
+	}
+	if (!args.HasArgs(0))
+	{
+		cloth->SetUseHierarchicalSolver(args.GetStringArgument(0) == "on");
+	}
+	if (args.HasArgs(2))
+	{
+		cloth->SetNumHierarchyIterationsPerLevel(args.GetIntArgument(1));
+	}
+	Console::instance->PrintLine(Stringf("Cloth hierarchy: %s, %u coarse levels, %u iterations per level", cloth->IsUsingHierarchicalSolver() ? "on" : "off", cloth->GetNumHierarchyLevels(), cloth->GetNumHierarchyIterationsPerLevel()), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothSelfCollision)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	if (!args.HasArgs(0) && !args.HasArgs(1) && !args.HasArgs(2))
+	{
+		Console::instance->PrintLine("clothSelfCollision [on | off] [thickness]", RGBA::GRAY);
+		return;
+	}
+	if (!args.HasArgs(0))
+	{
+		cloth->SetUseSelfCollision(args.GetStringArgument(0) == "on");
+	}
+	if (args.HasArgs(2))
+	{
+		cloth->SetSelfCollisionThickness(std::stof(args.GetStringArgument(1)));
+	}
+	Console::instance->PrintLine(Stringf("Cloth self-collision: %s, thickness %.3f, %u contacts last step", cloth->IsUsingSelfCollision() ? "on" : "off", cloth->GetSelfCollisionThickness(), cloth->GetNumSelfCollisionContacts()), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothSleep)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	if (!args.HasArgs(1) && !args.HasArgs(3))
+	{
+		Console::instance->PrintLine("clothSleep <on | off> [sleepDistance numStillUpdates]", RGBA::GRAY);
+	}
+	else
+	{
+		cloth->SetUseSleep(args.GetStringArgument(0) != "off");
+		if (args.HasArgs(3))
+		{
+			cloth->SetSleepDistance(std::stof(args.GetStringArgument(1)));
+			cloth->SetNumStillUpdatesToSleep(args.GetIntArgument(2));
+		}
+	}
+	Console::instance->PrintLine(Stringf("Cloth sleep: %s, distance %g per step for %u updates, %u of %u tiles asleep", cloth->IsUsingSleep() ? "on" : "off", cloth->GetSleepDistance(), cloth->GetNumStillUpdatesToSleep(), cloth->GetNumSleepingTiles(), cloth->GetNumSleepTiles()), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothTethers)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	if (!args.HasArgs(1) && !args.HasArgs(2))
+	{
+		Console::instance->PrintLine("clothTethers <on | off> [slack]", RGBA::GRAY);
+	}
+	else
+	{
+		cloth->SetUseTethers(args.GetStringArgument(0) != "off");
+		if (args.HasArgs(2))
+		{
+			cloth->SetTetherSlack(std::stof(args.GetStringArgument(1)));
+		}
+	}
+	Console::instance->PrintLine(Stringf("Cloth tethers: %s, slack %.2f, %u tethers", cloth->IsUsingTethers() ? "on" : "off", cloth->GetTetherSlack(), cloth->GetNumTethers()), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothTear)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	if (!args.HasArgs(0) && !args.HasArgs(1) && !args.HasArgs(3))
+	{
+		Console::instance->PrintLine("clothTear [stretchStrain] [shearStrain bendStrain] (0 never tears)", RGBA::GRAY);
+		return;
+	}
+	if (!args.HasArgs(0))
+	{
+		cloth->SetTearStrain(STRETCH, std::stof(args.GetStringArgument(0)));
+	}
+	if (args.HasArgs(3))
+	{
+		cloth->SetTearStrain(SHEAR, std::stof(args.GetStringArgument(1)));
+		cloth->SetTearStrain(BEND, std::stof(args.GetStringArgument(2)));
+	}
+	Console::instance->PrintLine(Stringf("Cloth tear strain: stretch %.2f, shear %.2f, bend %.2f; %u torn so far", cloth->GetTearStrain(STRETCH), cloth->GetTearStrain(SHEAR), cloth->GetTearStrain(BEND), cloth->GetNumTornConstraints()), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothWind)
+{
+	Cloth* cloth = TheGame::instance->m_cloth;
+	if (!args.HasArgs(1) && !args.HasArgs(4) && !args.HasArgs(6))
+	{
+		Console::instance->PrintLine("clothWind <on | off> [windX windY windZ] [dragCoefficient liftCoefficient]", RGBA::GRAY);
+	}
+	else
+	{
+		cloth->SetUseAerodynamics(args.GetStringArgument(0) != "off");
+		if (args.HasArgs(4) || args.HasArgs(6))
+		{
+			cloth->SetWindVelocity(Vector3(std::stof(args.GetStringArgument(1)), std::stof(args.GetStringArgument(2)), std::stof(args.GetStringArgument(3))));
+		}
+		if (args.HasArgs(6))
+		{
+			cloth->SetDragCoefficient(std::stof(args.GetStringArgument(4)));
+			cloth->SetLiftCoefficient(std::stof(args.GetStringArgument(5)));
+		}
+	}
+	Vector3 wind = cloth->GetWindVelocity();
+	Console::instance->PrintLine(Stringf("Cloth aerodynamics: %s, wind (%.1f, %.1f, %.1f) m/s, drag %.2f, lift %.2f", cloth->IsUsingAerodynamics() ? "on" : "off", wind.x, wind.y, wind.z, cloth->GetDragCoefficient(), cloth->GetLiftCoefficient()), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothRewind)
+{
+	ClothHistory* history = TheGame::instance->m_clothHistory;
+	if (args.HasArgs(1))
+	{
+		if (!history->Rewind(*TheGame::instance->m_cloth, args.GetIntArgument(0)))
+		{
+			Console::instance->PrintLine(Stringf("Only %u frames to rewind", history->GetNumSnapshots()), RGBA::GRAY);
+			return;
+		}
+		if (TheGame::instance->m_gameOver && !TheGame::instance->IsClothDestroyed())
+		{
+			TheGame::instance->ResetClothGameState(); //Rewound to before game over: the cloth is whole again, so let it fly.
+		}
+	}
+	else if (!args.HasArgs(0))
+	{
+		Console::instance->PrintLine("clothRewind [numFrames]", RGBA::GRAY);
+		return;
+	}
+	Console::instance->PrintLine(Stringf("Cloth history: %u of %u frames, %.1f KB", history->GetNumSnapshots(), history->GetMaxNumSnapshots(), history->GetNumBytes() / 1024.0), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothSquadron)
+{
+	//Hangs numCloths small cloths in rows behind the player's, replacing any squadron already out. They drop to coarser levels
+	//as the camera pulls away from them; the player's cloth always runs at full resolution.
+	if (!args.HasArgs(1))
+	{
+		Console::instance->PrintLine("clothSquadron <numCloths>", RGBA::GRAY);
+		return;
+	}
+	ClothWorld* world = TheGame::instance->m_clothWorld;
+	for (unsigned int clothIndex = world->GetNumCloths(); clothIndex-- > 0;)
+	{
+		if (world->GetCloth(clothIndex) != TheGame::instance->m_cloth)
+		{
+			world->RemoveCloth(world->GetCloth(clothIndex));
+		}
+	}
+
+	const int CLOTHS_PER_ROW = 25;
+	const float SPACING = 12.f;
+	int numCloths = args.GetIntArgument(0);
+	for (int clothIndex = 0; clothIndex < numCloths; ++clothIndex)
+	{
+		Vector3 offset(SPACING * (float)((clothIndex % CLOTHS_PER_ROW) - (CLOTHS_PER_ROW / 2)), SPACING * (float)(1 + (clothIndex / CLOTHS_PER_ROW)), 0.f);
+		world->AddClothLod(new ClothLod(TheGame::instance->s_clothStartingPosition + offset, PARTICLE_AABB3, 1.f, .01f, 10, 10, 5, 1.f, sqrt(2.f), 2.f));
+	}
+	Console::instance->PrintLine(Stringf("%u cloths in the world", world->GetNumCloths()), RGBA::WHITE);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(clothStats)
+{
+	UNUSED(args);
+	const ClothWorldStats& stats = TheGame::instance->m_clothWorld->GetStats();
+	Console::instance->PrintLine(Stringf("%u cloths (%u dead), %u particles, %u constraints, %u torn", stats.m_numCloths, stats.m_numDeadCloths, stats.m_numParticles, stats.m_numConstraints, stats.m_numTornConstraints), RGBA::WHITE);
+	Console::instance->PrintLine(Stringf("Last update: %u fixed steps in %.3f ms", stats.m_numFixedSteps, stats.m_updateMilliseconds), RGBA::WHITE);
+	Console::instance->PrintLine(Stringf("%u cloths below full resolution", stats.m_numReducedCloths), RGBA::WHITE);
 }
 
 //-----------------------------------------------------------------------------------
@@ -48,7 +387,9 @@ TheGame::TheGame()
 , m_startSFX(AudioSystem::instance->CreateOrGetSound("Data/SFX/start.wav"))
 , m_deathSFX(AudioSystem::instance->CreateOrGetSound("Data/SFX/death.wav"))
 , m_bgMusic(AudioSystem::instance->CreateOrGetSound("Data/SFX/battleTheme.mp3"))
-, m_cloth(new Cloth(s_clothStartingPosition, PARTICLE_AABB3, 1.f, .01f, 10, 10, 5, 1.f, sqrt(2.f), 2.f))
+, m_clothWorld(new ClothWorld(ThreadPool::instance))
+, m_cloth(m_clothWorld->AddCloth(new Cloth(s_clothStartingPosition, PARTICLE_AABB3, 1.f, .01f, 10, 10, 5, 1.f, sqrt(2.f), 2.f)))
+, m_clothHistory(new ClothHistory(CLOTH_HISTORY_LENGTH))
 , m_timeSinceLastParticle(0.0f)
 , m_gameOver(false)
 {
@@ -57,6 +398,8 @@ TheGame::TheGame()
 	m_hurtSounds[2] = AudioSystem::instance->CreateOrGetSound("Data/SFX/hurt2.wav");
 	m_hurtSounds[3] = AudioSystem::instance->CreateOrGetSound("Data/SFX/hurt3.wav");
 	m_hurtSounds[4] = AudioSystem::instance->CreateOrGetSound("Data/SFX/hurt4.wav");
+	m_cloth->SetUseAerodynamics(true);
+	m_cloth->SaveSnapshot(m_clothStartSnapshot);
 	Console::instance->RunCommand("motd");
 	AudioSystem::instance->PlayLoopingSound(m_bgMusic); //There's no way to stop it c:
 	AudioSystem::instance->PlaySound(m_startSFX);
@@ -65,7 +408,8 @@ TheGame::TheGame()
 //-----------------------------------------------------------------------------------
 TheGame::~TheGame()
 {
-	delete m_cloth;
+	delete m_clothHistory;
+	delete m_clothWorld;
 }
 
 //-----------------------------------------------------------------------------------
@@ -95,10 +439,14 @@ void TheGame::Update(float deltaTime)
 	}
 	if (m_numParticlesSpawned % 20 == 0 && InputSystem::instance->IsKeyDown('W'))
 	{
-		m_cloth->ResetForces(true);
-		m_cloth->AddForce(new ConstantWindForce(GetPseudoRandomNoise1D(m_numParticlesSpawned) * 3000.0f, Vector3(MathUtils::GetRandom(-1.0f, 1.0f), MathUtils::GetRandom(-1.0f, 1.0f), MathUtils::GetRandom(-1.0f, 1.0f))));
+		//A gust: the air itself moves, so the cloth catches it by how each triangle faces it rather than being pushed uniformly.
+		Vector3 gustDirection = Vector3::GetNormalized(Vector3(MathUtils::GetRandom(-1.0f, 1.0f), MathUtils::GetRandom(-1.0f, 1.0f), MathUtils::GetRandom(-1.0f, 1.0f)));
+		m_cloth->SetWindVelocity(gustDirection * (GetPseudoRandomNoise1D(m_numParticlesSpawned) * MAX_GUST_SPEED));
 	}
-	m_cloth->Update(deltaTime);
+	const float pixelsPerUnitAtUnitDistance = VIEWPORT_HEIGHT_PIXELS / (2.f * tan(MathUtils::DegreesToRadians(CAMERA_FOV_Y_DEGREES) * 0.5f));
+	m_clothWorld->SetViewpoint(m_camera->m_position, pixelsPerUnitAtUnitDistance);
+	m_clothWorld->Update(deltaTime);
+	m_clothHistory->Record(*m_cloth);
 
 	float timeForNextParticle = GetPseudoRandomNoise1D(m_numParticlesSpawned / 10);
 	timeForNextParticle = MathUtils::RangeMap(timeForNextParticle, 0.0f, 1.0f, 0.0f, 0.5f);
@@ -118,35 +466,48 @@ void TheGame::Update(float deltaTime)
 	{
 		bullet.Update(deltaTime);
 
-		auto particleIterator = m_cloth->m_clothParticles.begin();
-		while (particleIterator != m_cloth->m_clothParticles.end())
+		//Sweep the bullet across this frame's whole path against the cloth's triangles, so a fast one can't skip past between particles.
+		//The particle nearest where it struck is the one shot out. A triangle can outlive one of its corners (only the cell whose
+		//top-left was shot is removed), so a hit nearest an already-expired particle is the bullet still passing through the hole.
+		ClothSweepHit hit;
+		if (m_cloth->SweepSphere(bullet.m_prevState.GetPosition(), bullet.GetPosition(), bullet.m_radius, hit)
+			&& !m_cloth->IsParticleExpired(hit.GetNearestParticleIndex()))
 		{
-			LinearDynamicsState* clothParticleState = (*particleIterator).m_state;
-			Projectile clothParticle(1.0f, 0.1f, LinearDynamicsState(clothParticleState->GetPosition(), clothParticleState->GetVelocity()));
-			float collisionFactor = bullet.IsColliding(bullet, clothParticle);
-			if (collisionFactor != -1.0f)
-			{
-				particleIterator->SetIsExpired(true);
-				gotHit = true;
-			}
-			++particleIterator;
+			m_cloth->WakeTilesTouchingSphere(hit.m_position, bullet.m_radius); //Where it struck, which may be anywhere along the path.
+			m_cloth->SetParticleIsExpired(hit.GetNearestParticleIndex(), true);
+			gotHit = true;
 		}
-
 	}
 	if (gotHit)
 	{
 		AudioSystem::instance->PlaySound(m_hurtSounds[MathUtils::GetRandom(0, 5)]);
 	}
 	m_projectiles.erase(std::remove_if(m_projectiles.begin(), m_projectiles.end(), [](Projectile& bullet) {return (bullet.m_collided || (GetCurrentTimeSeconds() - bullet.m_birthday) > 15.0f); }), m_projectiles.end());
-	if (!m_gameOver && (m_cloth->IsDead() || m_cloth->GetPercentageConstraintsLeft() < 0.90f))
+	if (!m_gameOver && IsClothDestroyed())
 	{
 		AudioSystem::instance->PlaySound(m_deathSFX);
 		m_cloth->RemoveAllConstraints();
 		m_cloth->AddForce(new GravityForce(100.0f));
+		m_cloth->SetUseSelfCollision(true); //Keeps the unconstrained particles from falling through each other as the cloth piles up.
 		m_gameOver = true;
 	}
 }
 
+//-----------------------------------------------------------------------------------
+bool TheGame::IsClothDestroyed() const
+{
+	return m_cloth->IsDead() || m_cloth->GetPercentageConstraintsLeft() < 0.90f;
+}
+
+//-----------------------------------------------------------------------------------
+void TheGame::ResetClothGameState()
+{
+	m_cloth->ResetForces(false); //Snapshots don't hold forces, and game over adds extra gravity.
+	m_cloth->AddForce(new GravityForce(9.81f, Vector3(0, 0, -1))); //What a new Cloth starts with.
+	m_cloth->SetUseSelfCollision(false);
+	m_gameOver = false;
+}
+
 //-----------------------------------------------------------------------------------
 void TheGame::Render() const
 
@@ -158,7 +519,7 @@ void TheGame::Render() const
 	TheRenderer::instance->DrawTexturedAABB(AABB2(Vector2(0.0f, 0.0f), Vector2(300.f, 300.f)), Vector2(1.0f, 1.0f), Vector2(0.0f, 0.0f), m_marthTexture, RGBA::WHITE);
 	RenderAxisLines();
 
-	m_cloth->Render(true, InputSystem::instance->IsKeyDown('C'), InputSystem::instance->IsKeyDown('C'));
+	m_clothWorld->Render(true, InputSystem::instance->IsKeyDown('C'), InputSystem::instance->IsKeyDown('C'));
 	for (const Projectile& bullet : m_projectiles)
 	{
 		bullet.Render();
@@ -276,8 +637,7 @@ void TheGame::SetUp3DPerspective() const
 	const float aspect = 16.f / 9.f;
 	const float nearDist = 0.1f;
 	const float farDist = 1000.0f;
-	const float fovY = 50.0f;
-	TheRenderer::instance->SetPerspective(fovY, aspect, nearDist, farDist);
+	TheRenderer::instance->SetPerspective(CAMERA_FOV_Y_DEGREES, aspect, nearDist, farDist);
 
 	//Put Z up.
 	TheRenderer::instance->Rotate(-90.0f, 1.f, 0.f, 0.f);
@@ -8,6 +8,8 @@ class Texture;
 class RGBA;
 class Camera3D;
 class Cloth;
+class ClothWorld;
+class ClothHistory;
 
 class TheGame
 {
@@ -23,6 +25,8 @@ public:
 	void UpdateCamera(float deltaTime);
 	void SetUp3DPerspective() const;
 	void RenderAxisLines() const;
+	bool IsClothDestroyed() const; //Game over once m_cloth is dead or lost over 10% of its constraints.
+	void ResetClothGameState(); //Undoes what game over did to m_cloth's forces and collision, and clears m_gameOver.
 
 	//STATIC VARIABLES//////////////////////////////////////////////////////////////////////////
 	static TheGame* instance;
@@ -34,7 +38,10 @@ public:
 	SoundID m_deathSFX;
 	SoundID m_hurtSounds[5];
 	SoundID m_bgMusic;
-	Cloth* m_cloth;
+	ClothWorld* m_clothWorld; //Owns every cloth, including m_cloth.
+	Cloth* m_cloth; //The player's cloth: the one that moves, gets shot at and ends the game.
+	std::vector<unsigned char> m_clothStartSnapshot; //m_cloth as built, which resetCloth restores.
+	ClothHistory* m_clothHistory; //m_cloth's last few seconds, for clothRewind.
 	Texture* m_marthTexture;
 	std::vector<Projectile> m_projectiles;
 	bool m_gameOver;